@@ -0,0 +1,89 @@
+/*
+Compile: make array_file
+Run: ./array_file 1024 /tmp
+
+Saves and loads an int array of the given size in MB as an array file
+(copying and mapped) and as text (printia, then ia_read_file), and
+reports the time and throughput of each. The files are created in the
+given directory and removed afterwards.
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "base.h"
+#include "arrayfile.h"
+#include "parse.h"
+
+static timespec start_time;
+
+static void stop(String method, size_t bytes, long sum) {
+    double s = time_s_since(start_time);
+    printf("%-28s %8.3f s %8.1f MB/s (sum %ld)\n", method, s, bytes / s / 1e6, sum);
+}
+
+static long sum_ints(const int *a, size_t n) {
+    long sum = 0;
+    for (size_t i = 0; i < n; i++) sum += a[i];
+    return sum;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s megabytes directory", argv[0]);
+    int n = i_of_s(argv[1]) * (1024 * 1024 / sizeof(int));
+    size_t bytes = n * sizeof(int);
+    char binary_name[1024], text_name[1024];
+    snprintf(binary_name, sizeof(binary_name), "%s/array_file.bin", argv[2]);
+    snprintf(text_name, sizeof(text_name), "%s/array_file.txt", argv[2]);
+
+    int *a = xmalloc(bytes);
+    for (int i = 0; i < n; i++) a[i] = i_rnd(2000000000) - 1000000000;
+    long expected = sum_ints(a, n);
+
+    start_time = time_now();
+    ia_write_binary(binary_name, a, n);
+    stop("ia_write_binary", bytes, expected);
+
+    start_time = time_now();
+    int m;
+    int *b = ia_read_binary(binary_name, &m);
+    stop("ia_read_binary", bytes, sum_ints(b, m));
+    free(b);
+
+    start_time = time_now();
+    MappedArray ma = map_array_file(binary_name, ELEMENT_INT, false);
+    stop("map_array_file", bytes, 0);
+    start_time = time_now();
+    long sum = sum_ints(ma.ints, ma.count);
+    stop("map_array_file, sum", bytes, sum);
+    unmap_array_file(&ma);
+
+    start_time = time_now();
+    ma = map_array_file(binary_name, ELEMENT_INT, true);
+    sum = sum_ints(ma.ints, ma.count);
+    stop("map_array_file, verify, sum", bytes, sum);
+    unmap_array_file(&ma);
+
+    // printia writes to standard output, so redirect it to the text file
+    start_time = time_now();
+    fflush(stdout);
+    int saved_stdout = dup(1);
+    int fd = open(text_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    panic_if(fd < 0, "cannot open %s", text_name);
+    dup2(fd, 1);
+    close(fd);
+    printia(a, n);
+    fflush(stdout);
+    dup2(saved_stdout, 1);
+    close(saved_stdout);
+    stop("printia", bytes, expected);
+
+    start_time = time_now();
+    b = ia_read_file(text_name, "[], ", &m);
+    stop("ia_read_file", bytes, sum_ints(b, m));
+    free(b);
+
+    free(a);
+    unlink(binary_name);
+    unlink(text_name);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+Compile: make checksum
+Run: ./checksum big.txt 4
+
+Computes checksums of the contents of a file in memory: a CRC32C byte by
+byte, with tables (slicing by 8), with the crc32 instruction, in parallel
+on the given number of threads, and the 64-bit checksum. Reports the time
+and throughput of each.
+*/
+
+#include "base.h"
+#include "checksum.h"
+
+static timespec start_time;
+
+static void stop(String method, size_t bytes, uint64_t checksum) {
+    double s = time_s_since(start_time);
+    printf("%-26s %016lx %8.3f s %8.2f GB/s\n", method, (unsigned long)checksum, s, bytes / s / 1e9);
+}
+
+// The CRC32C one bit at a time, as in textbooks.
+static uint32_t crc32c_bitwise(const Byte *data, size_t n) {
+    uint32_t crc = ~0u;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78u : 0);
+    }
+    return ~crc;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s file threads", argv[0]);
+    size_t n;
+    Byte *data = read_file_data(argv[1], &n);
+    int n_threads = i_of_s(argv[2]);
+
+    size_t m = n < 100 * 1000 * 1000 ? n : 100 * 1000 * 1000;
+    start_time = time_now();
+    uint32_t crc = crc32c_bitwise(data, m);
+    stop("bitwise (first 100 MB)", m, crc);
+
+    start_time = time_now();
+    crc = crc32c_update_table(0, data, n);
+    stop("crc32c_update_table", n, crc);
+
+    start_time = time_now();
+    crc = crc32c(data, n);
+    stop("crc32c", n, crc);
+
+    char method[64];
+    for (int t = 1; t <= n_threads; t *= 2) {
+        start_time = time_now();
+        crc = crc32c_parallel(data, n, t);
+        snprintf(method, sizeof(method), "crc32c_parallel, %d thread%s", t, t == 1 ? "" : "s");
+        stop(method, n, crc);
+    }
+
+    start_time = time_now();
+    uint64_t h = checksum64(data, n);
+    stop("checksum64", n, h);
+
+    start_time = time_now();
+    crc = crc32c_file(argv[1]);
+    stop("crc32c_file", n, crc);
+
+    start_time = time_now();
+    h = checksum64_file(argv[1]);
+    stop("checksum64_file", n, h);
+
+    free(data);
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+Compile: make compression
+Run: ./compression big.txt /tmp
+
+Compresses and decompresses the contents of a file in memory, block by
+block, and reports the compression ratio and throughput. Then writes and
+reads the file with and without compression (in the given directory)
+and reports the time of each.
+*/
+
+#include <unistd.h>
+#include "base.h"
+#include "compress.h"
+
+static timespec start_time;
+
+static void stop(String method, size_t bytes) {
+    double s = time_s_since(start_time);
+    printf("%-24s %8.3f s %8.3f GB/s\n", method, s, bytes / s / 1e9);
+}
+
+#define BLOCK_SIZE (1024 * 1024)
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s file directory", argv[0]);
+    size_t n;
+    Byte *data = read_file_data(argv[1], &n);
+    printf("%s: %lu bytes\n", argv[1], (unsigned long)n);
+
+    size_t n_blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    Byte *packed = xmalloc(n_blocks * lz_compress_bound(BLOCK_SIZE));
+    size_t *packed_sizes = xmalloc((n_blocks + 1) * sizeof(size_t));
+    start_time = time_now();
+    size_t total = 0;
+    for (size_t i = 0; i < n_blocks; i++) {
+        size_t k = (i == n_blocks - 1) ? n - i * BLOCK_SIZE : BLOCK_SIZE;
+        packed_sizes[i] = lz_compress(data + i * BLOCK_SIZE, k, packed + total, lz_compress_bound(k));
+        total += packed_sizes[i];
+    }
+    stop("lz_compress", n);
+    printf("compressed to %lu bytes, ratio %.2f\n", (unsigned long)total, (double)n / total);
+
+    Byte *unpacked = xmalloc(n + 1);
+    start_time = time_now();
+    size_t offset = 0;
+    for (size_t i = 0; i < n_blocks; i++) {
+        size_t k = (i == n_blocks - 1) ? n - i * BLOCK_SIZE : BLOCK_SIZE;
+        lz_decompress(packed + offset, packed_sizes[i], unpacked + i * BLOCK_SIZE, k);
+        offset += packed_sizes[i];
+    }
+    stop("lz_decompress", n);
+    panic_if(memcmp(data, unpacked, n) != 0, "decompressed data differs");
+    free(unpacked);
+    free(packed);
+    free(packed_sizes);
+
+    char raw_name[1024], compressed_name[1024];
+    snprintf(raw_name, sizeof(raw_name), "%s/compression.raw", argv[2]);
+    snprintf(compressed_name, sizeof(compressed_name), "%s/compression.lz", argv[2]);
+
+    start_time = time_now();
+    write_file_data(raw_name, data, n);
+    stop("write_file_data", n);
+    start_time = time_now();
+    write_file_compressed(compressed_name, data, n);
+    stop("write_file_compressed", n);
+    free(data);
+
+    size_t m;
+    start_time = time_now();
+    data = read_file_data(raw_name, &m);
+    stop("read_file_data", m);
+    free(data);
+    start_time = time_now();
+    data = read_file_compressed(compressed_name, &m);
+    stop("read_file_compressed", m);
+    free(data);
+
+    unlink(raw_name);
+    unlink(compressed_name);
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*
+Compile: make count_text
+Run: ./count_text big.txt
+
+Counts the lines, words, and UTF-8 characters of a file with a getc loop
+and with count_file, and reports the time and throughput of each.
+*/
+
+#include "base.h"
+#include "count.h"
+
+static timespec start_time;
+
+static void stop(String method, TextCounts c) {
+    double s = time_s_since(start_time);
+    printf("%-12s %11lu lines %11lu words %11lu chars %8.3f s %8.1f MB/s\n", method,
+        (unsigned long)c.lines, (unsigned long)c.words, (unsigned long)c.chars,
+        s, c.bytes / s / 1e6);
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s file", argv[0]);
+    String name = argv[1];
+
+    start_time = time_now();
+    FILE *f = fopen(name, "r");
+    panic_if(f == NULL, "cannot open %s", name);
+    TextCounts c = make_text_counts();
+    int b;
+    while ((b = getc(f)) != EOF) {
+        bool space = b == ' ' || (b >= '\t' && b <= '\r');
+        if (b == '\n') c.lines++;
+        if (!space && !c.in_word) c.words++;
+        if ((b & 0xc0) != 0x80) c.chars++;
+        c.in_word = !space;
+        c.bytes++;
+    }
+    fclose(f);
+    stop("getc loop", c);
+
+    start_time = time_now();
+    c = count_file(name);
+    stop("count_file", c);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+Compile: make csv_read
+Run: ./csv_read 1024 /tmp
+
+Creates a CSV file of the given size in MB (in the given directory) with
+columns id (int), name (String), value (double), and count (int). Reads
+it by hand (for_each_line, splitting at commas, i_of_s and d_of_s per
+field) and with csv_read_file, and reports the rows per second of each.
+*/
+
+#include <unistd.h>
+#include "base.h"
+#include "csv.h"
+#include "stream.h"
+
+static timespec start_time;
+
+static void stop(String method, long rows, double sum) {
+    double s = time_s_since(start_time);
+    printf("%-14s %11ld rows %8.3f s %8.2f M rows/s (sum %g)\n", method, rows, s, rows / s / 1e6, sum);
+}
+
+static String names[] = { "apple", "banana", "cherry", "\"date, dried\"", "elderberry", "fig", "grape" };
+
+static void create_file(String name, long megabytes) {
+    FileWriter *w = fw_open(name, 0, 0);
+    fw_prints(w, "id,name,value,count\n");
+    for (int id = 0; w->bytes_written < megabytes * 1024 * 1024; id++) {
+        fw_printi(w, id);
+        fw_printc(w, ',');
+        fw_prints(w, names[id % 7]);
+        fw_printf(w, ",%.3f,", i_rnd(1000000) / 1000.0);
+        fw_printi(w, i_rnd(1000));
+        fw_printc(w, '\n');
+    }
+    fw_close(w);
+}
+
+// Splits the line at commas, handling the quoted name with a comma in it.
+static String next_field(String *line) {
+    String s = *line;
+    String end = (*s == '"') ? strchr(strchr(s + 1, '"'), ',') : strchr(s, ',');
+    if (end == NULL) end = s + strlen(s);
+    int n = end - s;
+    String field = xmalloc(n + 1);
+    memcpy(field, s, n);
+    field[n] = '\0';
+    *line = (*end == ',') ? end + 1 : end;
+    return field;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s megabytes directory", argv[0]);
+    char name[1024];
+    snprintf(name, sizeof(name), "%s/csv_read.csv", argv[2]);
+    create_file(name, i_of_s(argv[1]));
+
+    start_time = time_now();
+    FILE *f = fopen(name, "r");
+    panic_if(f == NULL, "cannot open %s", name);
+    int capacity = 1024, n = 0;
+    int *ids = xmalloc(capacity * sizeof(int));
+    String *strings = xmalloc(capacity * sizeof(String));
+    double *values = xmalloc(capacity * sizeof(double));
+    int *counts = xmalloc(capacity * sizeof(int));
+    bool header = true;
+    for_each_line(b, f) {
+        if (header) {
+            header = false;
+            continue;
+        }
+        if (n == capacity) {
+            capacity *= 2;
+            ids = xrealloc(ids, capacity * sizeof(int));
+            strings = xrealloc(strings, capacity * sizeof(String));
+            values = xrealloc(values, capacity * sizeof(double));
+            counts = xrealloc(counts, capacity * sizeof(int));
+        }
+        String line = b.s;
+        String field = next_field(&line);
+        ids[n] = i_of_s(field);
+        free(field);
+        strings[n] = next_field(&line);
+        field = next_field(&line);
+        values[n] = d_of_s(field);
+        free(field);
+        field = next_field(&line);
+        counts[n] = i_of_s(field);
+        free(field);
+        n++;
+    }
+    fclose(f);
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += values[i];
+    stop("by hand", n, sum);
+    // in reverse order, the most recent allocations are found first
+    for (int i = n - 1; i >= 0; i--) free(strings[i]);
+    free(ids);
+    free(strings);
+    free(values);
+    free(counts);
+
+    start_time = time_now();
+    CsvTable *t = csv_read_file(name, ',', true, NULL);
+    int value = csv_column_index(t, "value");
+    sum = 0;
+    for (int i = 0; i < t->n_rows; i++) sum += t->columns[value].doubles[i];
+    stop("csv_read_file", t->n_rows, sum);
+    csv_free(t);
+
+    unlink(name);
+    return 0;
+}
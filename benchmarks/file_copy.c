@@ -0,0 +1,61 @@
+/*
+Compile: make file_copy
+Run: ./file_copy big.txt copy.txt
+Run on pipes: cat big.txt | ./file_copy - - > copy.txt
+
+Copies a file with a getc/putc loop, with s_read_file and s_write_file, and
+with copy_file, and reports the time and throughput of each. With "-" as
+file names, copies standard input to standard output with copy_fd only.
+*/
+
+#include "base.h"
+#include "stream.h"
+
+static timespec start_time;
+
+static void stop(String method, size_t bytes) {
+    double s = time_s_since(start_time);
+    printf("%-22s %12lu bytes %8.3f s %8.1f MB/s\n", method, (unsigned long)bytes, s, bytes / s / 1e6);
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s from to", argv[0]);
+    String from = argv[1];
+    String to = argv[2];
+
+    if (s_equals(from, "-") && s_equals(to, "-")) {
+        CopyResult r = copy_fd(0, 1);
+        fprintf(stderr, "copy_fd (%s) %12lu bytes %8.3f s %8.1f MB/s\n", 
+                r.method, (unsigned long)r.bytes, r.seconds, r.mb_per_second);
+        return 0;
+    }
+
+    start_time = time_now();
+    FILE *f = fopen(from, "r");
+    panic_if(f == NULL, "cannot open %s", from);
+    FILE *g = fopen(to, "w");
+    panic_if(g == NULL, "cannot open %s", to);
+    size_t bytes = 0;
+    int c;
+    while ((c = getc(f)) != EOF) {
+        putc(c, g);
+        bytes++;
+    }
+    fclose(f);
+    panic_if(fclose(g) != 0, "cannot write %s", to);
+    stop("getc/putc", bytes);
+
+    start_time = time_now();
+    String s = s_read_file(from);
+    s_write_file(to, s);
+    free(s);
+    stop("s_read/write_file", bytes);
+
+    start_time = time_now();
+    CopyResult r = copy_file(from, to);
+    char method[64];
+    snprintf(method, sizeof(method), "copy_file (%s)", r.method);
+    stop(method, r.bytes);
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+Compile: make file_writer
+Run: ./file_writer out.txt 100000000
+
+Writes n small records (one integer per line) to a file with fprintf, with
+fwrite, and with a FileWriter, and reports the time and throughput of each.
+The FileWriter is also run with FW_ATOMIC | FW_SYNC.
+*/
+
+#include "base.h"
+#include "stream.h"
+
+static timespec start_time;
+
+static void stop(String method, size_t bytes, int records) {
+    double s = time_s_since(start_time);
+    printf("%-22s %11d records %8.3f s %8.1f MB/s %6.1f M records/s\n",
+            method, records, s, bytes / s / 1e6, records / s / 1e6);
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s file number_of_records", argv[0]);
+    String name = argv[1];
+    int n = i_of_s(argv[2]);
+
+    start_time = time_now();
+    FILE *f = fopen(name, "w");
+    panic_if(f == NULL, "cannot open %s", name);
+    size_t bytes = 0;
+    for (int i = 0; i < n; i++) {
+        bytes += fprintf(f, "%d\n", i);
+    }
+    panic_if(fclose(f) != 0, "cannot write %s", name);
+    stop("fprintf", bytes, n);
+
+    start_time = time_now();
+    f = fopen(name, "w");
+    panic_if(f == NULL, "cannot open %s", name);
+    char record[16];
+    for (int i = 0; i < n; i++) {
+        int k = snprintf(record, sizeof(record), "%d\n", i);
+        fwrite(record, 1, k, f);
+    }
+    panic_if(fclose(f) != 0, "cannot write %s", name);
+    stop("snprintf + fwrite", bytes, n);
+
+    start_time = time_now();
+    FileWriter *w = fw_open(name, 0, 0);
+    for (int i = 0; i < n; i++) {
+        fw_printi(w, i);
+        fw_printc(w, '\n');
+    }
+    bytes = w->bytes_written;
+    fw_close(w);
+    stop("fw_printi", bytes, n);
+
+    start_time = time_now();
+    w = fw_open(name, FW_ATOMIC | FW_SYNC, 0);
+    for (int i = 0; i < n; i++) {
+        fw_printi(w, i);
+        fw_printc(w, '\n');
+    }
+    fw_close(w);
+    stop("fw_printi atomic+sync", bytes, n);
+
+    return 0;
+}
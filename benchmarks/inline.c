@@ -0,0 +1,103 @@
+/*
+Compile: make inline OPT=-O3
+Run: ./inline
+
+Measures loops over the inline functions of base.h and basedefs.h, such
+as s_get and make_int_pair, against the same loops with calls of the
+out-of-line definitions in the library, and against plain array access.
+The loops marked "vectorizes" must be vectorized at -O3, which
+"make inline-check" verifies in the compiler's optimization report.
+*/
+
+#include "base.h"
+#include "bench.h"
+
+#define N 1000
+
+static char text[N + 1];
+static IntPair pairs[N];
+static IntOption options[N];
+
+// calls through these pointers are not inlined
+static char (*volatile get_call)(String s, int i) = s_get;
+static IntPair (*volatile make_int_pair_call)(int i, int j) = make_int_pair;
+
+static int sum_s_get(String s) {
+    int sum = 0;
+    int n = s_length(s);
+    for (int i = 0; i < n; i++) sum += s_get(s, i); // vectorizes
+    return sum;
+}
+
+static int sum_array(String s, int n) {
+    int sum = 0;
+    for (int i = 0; i < n; i++) sum += s[i]; // vectorizes
+    return sum;
+}
+
+static void fill_pairs(IntPair *a, int n) {
+    for (int i = 0; i < n; i++) a[i] = make_int_pair(i, 2 * i); // vectorizes
+}
+
+static void fill_options(IntOption *a, int n) {
+    for (int i = 0; i < n; i++) a[i] = (i % 3 == 0) ? make_int_none() : make_int_some(i);
+}
+
+BENCHMARK(s_get_inline) {
+    for (int64_t i = 0; i < iterations; i++) {
+        bench_do_not_optimize(sum_s_get(text));
+        bench_clobber();
+    }
+}
+
+BENCHMARK(s_get_call) {
+    char (*get)(String s, int i) = get_call;
+    for (int64_t i = 0; i < iterations; i++) {
+        int sum = 0;
+        int n = s_length(text);
+        for (int j = 0; j < n; j++) sum += get(text, j);
+        bench_do_not_optimize(sum);
+        bench_clobber();
+    }
+}
+
+BENCHMARK(array_access) {
+    for (int64_t i = 0; i < iterations; i++) {
+        bench_do_not_optimize(sum_array(text, N));
+        bench_clobber();
+    }
+}
+
+BENCHMARK(make_int_pair_inline) {
+    for (int64_t i = 0; i < iterations; i++) {
+        fill_pairs(pairs, N);
+        bench_clobber();
+    }
+}
+
+BENCHMARK(make_int_pair_call) {
+    IntPair (*make)(int i, int j) = make_int_pair_call;
+    for (int64_t i = 0; i < iterations; i++) {
+        for (int j = 0; j < N; j++) pairs[j] = make(j, 2 * j);
+        bench_clobber();
+    }
+}
+
+BENCHMARK(make_int_option_inline) {
+    for (int64_t i = 0; i < iterations; i++) {
+        fill_options(options, N);
+        bench_clobber();
+    }
+}
+
+BENCHMARK(s_equals_inline) {
+    for (int64_t i = 0; i < iterations; i++) {
+        bench_do_not_optimize(s_equals(text, text + 1));
+    }
+}
+
+int main(int argc, String argv[]) {
+    for (int i = 0; i < N; i++) text[i] = 'a' + i % 26;
+    text[N] = '\0';
+    return bench_main(argc, argv);
+}
@@ -0,0 +1,60 @@
+/*
+Compile: make line_index
+Run: ./line_index big.txt
+
+Builds the line index of a file in memory, then with persisting (the first
+run saves big.txt.lidx, later runs map it), and measures the latency of
+looking up random lines, compared to scanning for line breaks from the
+start of the file.
+*/
+
+#include "base.h"
+#include "lineindex.h"
+
+// Finds line k by scanning for line breaks from the start.
+static StringView scan_line(const Byte *data, size_t size, size_t k) {
+    const Byte *p = data;
+    const Byte *end = data + size;
+    for (size_t i = 0; i < k; i++) {
+        p = (const Byte*)memchr(p, '\n', end - p) + 1;
+    }
+    const Byte *nl = memchr(p, '\n', end - p);
+    return make_string_view((const char*)p, (nl == NULL ? end : nl) - p);
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s file", argv[0]);
+    String name = argv[1];
+
+    timespec start = time_now();
+    LineIndex *x = li_of_file(name, false);
+    printf("build in memory:  %10zu lines %10.3f s\n", x->n_lines, time_s_since(start));
+    li_free(x);
+
+    start = time_now();
+    x = li_of_file(name, true);
+    printf("persistent index: %10zu lines %10.3f s (%s)\n", x->n_lines, time_s_since(start),
+        x->index.data != NULL ? "mapped from index file" : "built and saved");
+    panic_if(x->n_lines == 0, "empty file");
+
+    int n = 10 * 1000 * 1000;
+    size_t sum = 0;
+    start = time_now();
+    for (int i = 0; i < n; i++) {
+        size_t k = ((size_t)rand() * RAND_MAX + rand()) % x->n_lines;
+        sum += li_line(x, k).length;
+    }
+    printf("li_line:          %10d lookups %8.1f ns per lookup (%zu)\n", n, time_s_since(start) * 1e9 / n, sum);
+
+    n = 20;
+    sum = 0;
+    start = time_now();
+    for (int i = 0; i < n; i++) {
+        size_t k = ((size_t)rand() * RAND_MAX + rand()) % x->n_lines;
+        sum += scan_line(x->data, x->size, k).length;
+    }
+    printf("scan from start:  %10d lookups %8.1f ns per lookup (%zu)\n", n, time_s_since(start) * 1e9 / n, sum);
+
+    li_free(x);
+    return 0;
+}
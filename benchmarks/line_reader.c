@@ -0,0 +1,70 @@
+/*
+Compile: make line_reader
+Run: ./line_reader big.txt
+Create a test file: seq 1 200000000 > big.txt
+
+Counts the lines of a file with getchar, fgets, read_line, and lr_next and
+reports the time and throughput of each method.
+*/
+
+#include "base.h"
+#include "stream.h"
+
+static timespec start_time;
+
+static void stop(String method, long bytes, long lines) {
+    double s = time_s_since(start_time);
+    printf("%-10s %12ld lines %9.3f s %9.1f MB/s\n", method, lines, s, bytes / s / 1e6);
+}
+
+static FILE *open_input(String name) {
+    FILE *f = fopen(name, "r");
+    panic_if(f == NULL, "cannot open %s", name);
+    return f;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s file", argv[0]);
+    String name = argv[1];
+    long bytes = 0;
+    long lines = 0;
+
+    start_time = time_now();
+    FILE *f = open_input(name);
+    int c;
+    while ((c = getc(f)) != EOF) {
+        bytes++;
+        if (c == '\n') lines++;
+    }
+    fclose(f);
+    stop("getc", bytes, lines);
+
+    start_time = time_now();
+    f = open_input(name);
+    char line[4096];
+    lines = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strchr(line, '\n') != NULL) lines++;
+    }
+    fclose(f);
+    stop("fgets", bytes, lines);
+
+    start_time = time_now();
+    f = open_input(name);
+    LineBuffer b = make_line_buffer();
+    lines = 0;
+    while (read_line(&b, f)) lines++;
+    free_line_buffer(&b);
+    fclose(f);
+    stop("read_line", bytes, lines);
+
+    start_time = time_now();
+    LineReader *r = lr_open(name, 0);
+    StringView v;
+    lines = 0;
+    while (lr_next(r, &v)) lines++;
+    lr_close(r);
+    stop("lr_next", bytes, lines);
+
+    return 0;
+}
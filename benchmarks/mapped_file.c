@@ -0,0 +1,61 @@
+/*
+Compile: make mapped_file
+Run: ./mapped_file big.txt
+Create a test file: seq 1 400000000 > big.txt
+
+Counts the lines of a file that has been read with s_read_file and of a
+file that has been mapped with map_file. Each method runs in its own
+process, such that the peak resident set size (RSS) of each can be
+reported.
+*/
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "base.h"
+#include "mapfile.h"
+
+static long count_lines(const Byte *data, size_t n) {
+    long lines = 0;
+    const Byte *end = data + n;
+    for (const Byte *p = data; (p = memchr(p, '\n', end - p)) != NULL; p++) lines++;
+    return lines;
+}
+
+static void run(String method, String name) {
+    timespec t0 = time_now();
+    long lines = 0;
+    size_t size = 0;
+    if (s_equals(method, "s_read_file")) {
+        String s = s_read_file(name);
+        size = strlen(s);
+        lines = count_lines((Byte*)s, size);
+        free(s);
+    } else if (s_equals(method, "map_file")) {
+        MappedFile m = map_file(name, ADVICE_SEQUENTIAL);
+        size = m.size;
+        lines = count_lines(m.data, m.size);
+        unmap_file(&m);
+    }
+    double s = time_s_since(t0);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("%-12s %11ld lines %8.3f s %8.1f MB/s, peak RSS %8.1f MB\n",
+            method, lines, s, size / s / 1e6, usage.ru_maxrss / 1024.0);
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s file", argv[0]);
+    String methods[] = { "s_read_file", "map_file" };
+    for (int i = 0; i < 2; i++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        panic_if(pid < 0, "cannot fork");
+        if (pid == 0) {
+            run(methods[i], argv[1]);
+            return 0;
+        }
+        waitpid(pid, NULL, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+Compile: make metrics
+Run: ./metrics
+
+Measures the cost of updating a counter, a gauge, and a histogram, and
+of a contract check, which the library counts. Then counts and times
+a small computation on two threads and prints all metrics, including
+those of the library: contract checks, allocations, and bytes read
+and written.
+*/
+
+#include <pthread.h>
+#include "base.h"
+#include "bench.h"
+#include "metrics.h"
+
+BENCHMARK(empty_loop) {
+    for (int64_t i = 0; i < iterations; i++) {
+        bench_clobber();
+    }
+}
+
+BENCHMARK(counter_add) {
+    Metric *m = metric_counter("bench.counter");
+    for (int64_t i = 0; i < iterations; i++) {
+        metric_add(m, 1);
+    }
+}
+
+BENCHMARK(gauge_set) {
+    Metric *m = metric_gauge("bench.gauge");
+    for (int64_t i = 0; i < iterations; i++) {
+        metric_set(m, i);
+    }
+}
+
+BENCHMARK(histogram_record) {
+    Metric *m = metric_histogram("bench.histogram");
+    for (int64_t i = 0; i < iterations; i++) {
+        metric_record(m, i & 0xffff);
+    }
+}
+
+BENCHMARK(require) {
+    for (int64_t i = 0; i < iterations; i++) {
+        require("not negative", i >= 0);
+        bench_clobber();
+    }
+}
+
+static void *work(void *arg) {
+    Metric *roots = metric_counter("work.roots");
+    Metric *latency = metric_histogram("work.sum_of_roots_ns");
+    double sum = 0;
+    for (int k = 1; k <= 100; k++) {
+        int64_t start = time_ns();
+        for (int i = 0; i < k * 1000; i++) sum += sqrt(i);
+        metric_record(latency, time_ns_since(start));
+        metric_add(roots, k * 1000);
+    }
+    *(double*)arg = sum;
+    return NULL;
+}
+
+int main(int argc, String argv[]) {
+    int status = bench_main(argc, argv);
+
+    Metric *threads = metric_gauge("work.threads");
+    metric_set(threads, 2);
+    pthread_t thread;
+    double sums[2];
+    pthread_create(&thread, NULL, work, &sums[0]);
+    work(&sums[1]);
+    pthread_join(thread, NULL);
+    String file = "metrics.tmp";
+    s_write_file(file, "some text\n");
+    String s = s_read_file(file);
+    free(s);
+    remove(file);
+    printf("sums %g %g\n\n", sums[0], sums[1]);
+    metrics_print(stdout, METRICS_TEXT);
+    metrics_print_at_exit(NULL, METRICS_JSON);
+    return status;
+}
@@ -0,0 +1,93 @@
+/*
+Compile: make parallel_count
+Run: ./parallel_count big.txt 8
+
+Counts the lines and words of a file with a single-threaded getc loop (as
+in line_counting.c) and with map_reduce_file on the given number of
+threads, and reports the time of each.
+*/
+
+#include "base.h"
+#include "parallel.h"
+
+static timespec start_time;
+
+static void stop(String method, long lines, long words) {
+    double s = time_s_since(start_time);
+    printf("%-26s %11ld lines %11ld words %8.3f s\n", method, lines, words, s);
+}
+
+typedef struct Counts {
+    long lines;
+    long words;
+} Counts;
+
+static void count_lines(Chunk chunk, Any result, Any context) {
+    long lines = 0;
+    const Byte *end = chunk.data + chunk.size;
+    for (const Byte *p = chunk.data; (p = memchr(p, '\n', end - p)) != NULL; p++) lines++;
+    *(long*)result = lines;
+}
+
+static void add_lines(Any result, ConstAny partial, Any context) {
+    *(long*)result += *(const long*)partial;
+}
+
+static void count_words(Chunk chunk, Any result, Any context) {
+    Counts c = { 0, 0 };
+    bool in_word = false;
+    for (size_t i = 0; i < chunk.size; i++) {
+        Byte b = chunk.data[i];
+        bool space = b == ' ' || b == '\n' || b == '\t' || b == '\r';
+        if (b == '\n') c.lines++;
+        if (!space && !in_word) c.words++;
+        in_word = !space;
+    }
+    *(Counts*)result = c;
+}
+
+static void add_counts(Any result, ConstAny partial, Any context) {
+    Counts *c = result;
+    const Counts *p = partial;
+    c->lines += p->lines;
+    c->words += p->words;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s file threads", argv[0]);
+    String name = argv[1];
+    int n_threads = i_of_s(argv[2]);
+
+    start_time = time_now();
+    FILE *f = fopen(name, "r");
+    panic_if(f == NULL, "cannot open %s", name);
+    long lines = 0;
+    long words = 0;
+    bool in_word = false;
+    int c;
+    while ((c = getc(f)) != EOF) {
+        bool space = c == ' ' || c == '\n' || c == '\t' || c == '\r';
+        if (c == '\n') lines++;
+        if (!space && !in_word) words++;
+        in_word = !space;
+    }
+    fclose(f);
+    stop("getc loop", lines, words);
+
+    char method[64];
+    for (int t = 1; t <= n_threads; t *= 2) {
+        start_time = time_now();
+        lines = 0;
+        map_reduce_file(name, t, sizeof(long), count_lines, add_lines, &lines, NULL);
+        snprintf(method, sizeof(method), "lines, %d thread%s", t, t == 1 ? "" : "s");
+        stop(method, lines, 0);
+
+        start_time = time_now();
+        Counts counts = { 0, 0 };
+        map_reduce_file(name, t, sizeof(Counts), count_words, add_counts, &counts, NULL);
+        snprintf(method, sizeof(method), "lines+words, %d thread%s", t, t == 1 ? "" : "s");
+        stop(method, counts.lines, counts.words);
+    }
+
+    return 0;
+}
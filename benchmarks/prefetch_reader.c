@@ -0,0 +1,103 @@
+/*
+Compile: make prefetch_reader
+Run: ./prefetch_reader big.txt 500
+
+Processes a file block by block, once with a synchronous read loop and
+once with a PrefetchReader, and reports the time of each. Processing is a
+hash over every byte, which costs about as much as simple parsing.
+
+The second argument emulates a device with the given throughput in MB/s:
+a child process feeds the file through a pipe in 64 KB chunks and waits
+for the transfer time of each chunk before delivering it. With 0, the
+file is read directly (usually from the page cache).
+*/
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "base.h"
+#include "stream.h"
+
+#define BLOCK_SIZE (4 * 1024 * 1024)
+
+// Opens the file, or a pipe that delivers the file at the given rate.
+static int open_source(String name, double mb_per_second, pid_t *child) {
+    int fd = open(name, O_RDONLY);
+    panic_if(fd < 0, "cannot open %s", name);
+    *child = 0;
+    if (mb_per_second <= 0) return fd;
+    int p[2];
+    panic_if(pipe(p) != 0, "cannot create pipe");
+    *child = fork();
+    panic_if(*child < 0, "cannot fork");
+    if (*child == 0) {
+        close(p[0]);
+        // like a device, deliver the next chunk only after it has been requested
+        int chunk = 64 * 1024;
+        char *buffer = xmalloc(chunk);
+        ssize_t k;
+        while ((k = read(fd, buffer, chunk)) > 0) {
+            usleep(k / (mb_per_second * 1e6) * 1e6);
+            if (write(p[1], buffer, k) != k) break;
+        }
+        _exit(0);
+    }
+    close(fd);
+    close(p[1]);
+    return p[0];
+}
+
+static void close_source(int fd, pid_t child) {
+    close(fd);
+    if (child > 0) waitpid(child, NULL, 0);
+}
+
+static unsigned process(const Byte *data, int n, unsigned hash) {
+    for (int i = 0; i < n; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 3, "usage: %s file device_mb_per_second", argv[0]);
+    String name = argv[1];
+    double rate = d_of_s(argv[2]);
+    pid_t child;
+
+    timespec t0 = time_now();
+    int fd = open_source(name, rate, &child);
+    Byte *buffer = xmalloc(BLOCK_SIZE);
+    unsigned hash = 2166136261u;
+    size_t bytes = 0;
+    for (;;) {
+        int n = 0;
+        ssize_t k;
+        while (n < BLOCK_SIZE && (k = read(fd, buffer + n, BLOCK_SIZE - n)) > 0) n += k;
+        if (n == 0) break;
+        hash = process(buffer, n, hash);
+        bytes += n;
+    }
+    free(buffer);
+    close_source(fd, child);
+    double s = time_s_since(t0);
+    printf("%-16s %12lu bytes %8.3f s %8.1f MB/s (hash %08x)\n", "read + process", (unsigned long)bytes, s, bytes / s / 1e6, hash);
+
+    t0 = time_now();
+    fd = open_source(name, rate, &child);
+    PrefetchReader *r = pr_of_fd(fd, BLOCK_SIZE, 0);
+    hash = 2166136261u;
+    bytes = 0;
+    const Byte *data;
+    int n;
+    while (pr_next(r, &data, &n)) {
+        hash = process(data, n, hash);
+        bytes += n;
+    }
+    pr_close(r);
+    close_source(fd, child);
+    s = time_s_since(t0);
+    printf("%-16s %12lu bytes %8.3f s %8.1f MB/s (hash %08x)\n", "pr_next + process", (unsigned long)bytes, s, bytes / s / 1e6, hash);
+
+    return 0;
+}
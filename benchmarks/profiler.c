@@ -0,0 +1,55 @@
+/*
+Compile: make profiler
+Run: ./profiler profile.folded
+
+Runs a computation with two parts, of which one takes about twice as
+long as the other, without and with the profiler. Reports the time of
+each run and writes the samples as folded stacks to the given file.
+Render it with flamegraph.pl or https://www.speedscope.app.
+*/
+
+#include "base.h"
+#include "profile.h"
+
+__attribute__((noinline)) static double sum_of_roots(int n) {
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += sqrt(i);
+    return sum;
+}
+
+__attribute__((noinline)) static double sum_of_logs(int n) {
+    double sum = 0;
+    for (int i = 1; i <= n; i++) sum += log(i);
+    return sum;
+}
+
+__attribute__((noinline)) static double compute(int n) {
+    double sum = 0;
+    for (int k = 0; k < 20; k++) {
+        sum += sum_of_roots(2 * n);
+        sum += sum_of_logs(n);
+    }
+    return sum;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s profile.folded", argv[0]);
+    int n = 2000000;
+
+    timespec t = time_now();
+    double sum = compute(n);
+    printf("without profiler: %8.1f ms (sum %g)\n", time_ms_since(t), sum);
+
+    t = time_now();
+    profile_start(NULL, 0);
+    sum = compute(n);
+    profile_stop();
+    double ms = time_ms_since(t);
+    int dropped;
+    int samples = profile_samples(&dropped);
+    printf("with profiler:    %8.1f ms (sum %g), %d samples, %d dropped\n", ms, sum, samples, dropped);
+
+    profile_write(argv[1]);
+    printf("profile written to %s\n", argv[1]);
+    return 0;
+}
@@ -0,0 +1,42 @@
+/*
+Compile: make read_file
+Run: ./read_file big.txt
+Run on a pipe: cat big.txt | ./read_file /dev/stdin
+Create a test file: seq 1 300000000 > big.txt
+
+Reads a whole file with s_read_file and with read_file_data and reports the
+time and throughput of each. If the file is a pipe, it can be read only
+once, so only s_read_file is run.
+*/
+
+#include <sys/stat.h>
+#include "base.h"
+
+static timespec start_time;
+
+static void stop(String method, size_t bytes) {
+    double s = time_s_since(start_time);
+    printf("%-15s %12lu bytes %8.3f s %8.1f MB/s\n", method, (unsigned long)bytes, s, bytes / s / 1e6);
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s file", argv[0]);
+    String name = argv[1];
+    struct stat st;
+    panic_if(stat(name, &st) != 0, "cannot access %s", name);
+
+    start_time = time_now();
+    String s = s_read_file(name);
+    stop("s_read_file", strlen(s));
+    free(s);
+
+    if (S_ISREG(st.st_mode)) {
+        start_time = time_now();
+        size_t n = 0;
+        Byte *data = read_file_data(name, &n);
+        stop("read_file_data", n);
+        free(data);
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+Compile: make read_numbers
+Run: ./read_numbers numbers.txt
+Create a test file: seq -1000000 3 100000000 > numbers.txt
+
+Reads all integers of a file with i_input, with fscanf, and with
+ia_read_file and reports the time and throughput of each method. Then does
+the same for doubles.
+*/
+
+#include "base.h"
+#include "parse.h"
+
+static timespec start_time;
+
+static void stop(String method, long bytes, long count, double sum) {
+    double s = time_s_since(start_time);
+    printf("%-14s %11ld numbers (sum %g) %8.3f s %8.1f MB/s\n", method, count, sum, s, bytes / s / 1e6);
+}
+
+static long file_size(String name) {
+    FILE *f = fopen(name, "r");
+    panic_if(f == NULL, "cannot open %s", name);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+static long count_lines(String name) {
+    FILE *f = fopen(name, "r");
+    panic_if(f == NULL, "cannot open %s", name);
+    long lines = 0;
+    int c;
+    while ((c = getc(f)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    fclose(f);
+    return lines;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s file (one number per line)", argv[0]);
+    String name = argv[1];
+    long bytes = file_size(name);
+    long lines = count_lines(name);
+
+    start_time = time_now();
+    panic_if(freopen(name, "r", stdin) == NULL, "cannot open %s", name);
+    double sum = 0;
+    for (long i = 0; i < lines; i++) sum += i_input();
+    stop("i_input", bytes, lines, sum);
+
+    start_time = time_now();
+    FILE *f = fopen(name, "r");
+    int x;
+    long count = 0;
+    sum = 0;
+    while (fscanf(f, "%d", &x) == 1) {
+        sum += x;
+        count++;
+    }
+    fclose(f);
+    stop("fscanf %d", bytes, count, sum);
+
+    start_time = time_now();
+    int n = 0;
+    int *a = ia_read_file(name, NULL, &n);
+    sum = 0;
+    for (int i = 0; i < n; i++) sum += a[i];
+    free(a);
+    stop("ia_read_file", bytes, n, sum);
+
+    start_time = time_now();
+    panic_if(freopen(name, "r", stdin) == NULL, "cannot open %s", name);
+    sum = 0;
+    for (long i = 0; i < lines; i++) sum += d_input();
+    stop("d_input", bytes, lines, sum);
+
+    start_time = time_now();
+    f = fopen(name, "r");
+    double d;
+    count = 0;
+    sum = 0;
+    while (fscanf(f, "%lf", &d) == 1) {
+        sum += d;
+        count++;
+    }
+    fclose(f);
+    stop("fscanf %lf", bytes, count, sum);
+
+    start_time = time_now();
+    double *b = da_read_file(name, NULL, &n);
+    sum = 0;
+    for (int i = 0; i < n; i++) sum += b[i];
+    free(b);
+    stop("da_read_file", bytes, n, sum);
+
+    return 0;
+}
@@ -0,0 +1,271 @@
+/*
+Compile: make suite
+Run: ./suite
+Run from lib: make bench
+
+Benchmarks the functions of base.h that programs call most often, with
+realistic sizes. The results of the current library are recorded in
+baseline.json. "make bench" in lib compares with this baseline, "make
+bench-baseline" records a new one.
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "base.h"
+#include "bench.h"
+
+#define LIVE_BLOCKS 10000
+#define STRING_LENGTH 1000
+#define ARRAY_LENGTH 1000
+#define INPUT_LINES 100000
+
+static Any live[LIVE_BLOCKS];
+static int oldest = 0;
+static String text; // STRING_LENGTH characters
+static int ints[ARRAY_LENGTH];
+static double doubles[ARRAY_LENGTH];
+static String strings[ARRAY_LENGTH];
+static char small_file[] = "/tmp/suite_small_XXXXXX";
+static char large_file[] = "/tmp/suite_large_XXXXXX";
+static char input_file[] = "/tmp/suite_input_XXXXXX";
+static int input_line = 0;
+
+////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+static int saved_stdout = -1;
+
+// Sends the output of the print functions to /dev/null.
+static void silence_stdout(void) {
+    fflush(stdout);
+    saved_stdout = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+}
+
+static void restore_stdout(void) {
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+}
+
+static void create_temp_file(char *name, String contents) {
+    int fd = mkstemp(name);
+    panic_if(fd < 0, "cannot create %s", name);
+    close(fd);
+    s_write_file(name, contents);
+}
+
+// Creates a String of n characters, repeating the given pattern.
+static String repeat(String pattern, int n) {
+    String s = xmalloc(n + 1);
+    int k = strlen(pattern);
+    for (int i = 0; i < n; i++) s[i] = pattern[i % k];
+    s[n] = '\0';
+    return s;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Memory
+
+// Allocates and immediately frees a block, the best case for tracking.
+BENCHMARK(xmalloc_free_64) {
+    for (int64_t i = 0; i < iterations; i++) {
+        Any p = xmalloc(64);
+        bench_do_not_optimize(p);
+        free(p);
+    }
+}
+
+// Replaces the oldest of 10000 live blocks, the worst case for tracking.
+BENCHMARK(xmalloc_free_64_live_10000) {
+    for (int64_t i = 0; i < iterations; i++) {
+        free(live[oldest]);
+        live[oldest] = xmalloc(64);
+        oldest = (oldest + 1) % LIVE_BLOCKS;
+    }
+}
+
+BENCHMARK(xmalloc_free_1mb) {
+    for (int64_t i = 0; i < iterations; i++) {
+        Any p = xmalloc(1024 * 1024);
+        bench_do_not_optimize(p);
+        free(p);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Strings
+
+BENCHMARK(s_copy_1000) {
+    for (int64_t i = 0; i < iterations; i++) {
+        String s = s_copy(text);
+        bench_do_not_optimize(s);
+        free(s);
+    }
+}
+
+BENCHMARK(s_get) {
+    int sum = 0;
+    for (int64_t i = 0; i < iterations; i++) {
+        sum += s_get(text, i % STRING_LENGTH);
+    }
+    bench_do_not_optimize(sum);
+}
+
+BENCHMARK(s_contains_1000_miss) {
+    for (int64_t i = 0; i < iterations; i++) {
+        bool b = s_contains(text, "zyx");
+        bench_do_not_optimize(b);
+    }
+}
+
+BENCHMARK(s_contains_1000_hit) {
+    for (int64_t i = 0; i < iterations; i++) {
+        bool b = s_contains(text, "mnop");
+        bench_do_not_optimize(b);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Conversion
+
+BENCHMARK(i_of_s) {
+    for (int64_t i = 0; i < iterations; i++) {
+        int x = i_of_s("1234567");
+        bench_do_not_optimize(x);
+    }
+}
+
+BENCHMARK(d_of_s) {
+    for (int64_t i = 0; i < iterations; i++) {
+        double x = d_of_s("3.14159265");
+        bench_do_not_optimize(x);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Output
+
+BENCHMARK(printia_1000) {
+    silence_stdout();
+    for (int64_t i = 0; i < iterations; i++) printia(ints, ARRAY_LENGTH);
+    restore_stdout();
+}
+
+BENCHMARK(printda_1000) {
+    silence_stdout();
+    for (int64_t i = 0; i < iterations; i++) printda(doubles, ARRAY_LENGTH);
+    restore_stdout();
+}
+
+BENCHMARK(printsa_1000) {
+    silence_stdout();
+    for (int64_t i = 0; i < iterations; i++) printsa(strings, ARRAY_LENGTH);
+    restore_stdout();
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Input and files
+
+BENCHMARK(s_read_file_4kb) {
+    for (int64_t i = 0; i < iterations; i++) {
+        String s = s_read_file(small_file);
+        bench_do_not_optimize(s);
+        free(s);
+    }
+}
+
+BENCHMARK(s_read_file_4mb) {
+    for (int64_t i = 0; i < iterations; i++) {
+        String s = s_read_file(large_file);
+        bench_do_not_optimize(s);
+        free(s);
+    }
+}
+
+BENCHMARK(s_input) {
+    for (int64_t i = 0; i < iterations; i++) {
+        if (input_line == INPUT_LINES) {
+            rewind(stdin);
+            input_line = 0;
+        }
+        String s = s_input(100);
+        input_line++;
+        bench_do_not_optimize(s);
+        free(s);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Random numbers
+
+BENCHMARK(i_rnd) {
+    for (int64_t i = 0; i < iterations; i++) {
+        int x = i_rnd(1000);
+        bench_do_not_optimize(x);
+    }
+}
+
+BENCHMARK(d_rnd) {
+    for (int64_t i = 0; i < iterations; i++) {
+        double x = d_rnd(1.0);
+        bench_do_not_optimize(x);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Testing
+
+// The test functions count the tests, which are reported when the program exits.
+// The benchmarks restore the counts, they are not tests.
+
+BENCHMARK(test_equal_i) {
+    int count = base_check_count, success_count = base_check_success_count;
+    silence_stdout();
+    for (int64_t i = 0; i < iterations; i++) test_equal_i((int)i, (int)i);
+    restore_stdout();
+    base_check_count = count;
+    base_check_success_count = success_count;
+}
+
+BENCHMARK(test_equal_s) {
+    int count = base_check_count, success_count = base_check_success_count;
+    silence_stdout();
+    for (int64_t i = 0; i < iterations; i++) test_equal_s(text, text);
+    restore_stdout();
+    base_check_count = count;
+    base_check_success_count = success_count;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, String argv[]) {
+    for (int i = 0; i < LIVE_BLOCKS; i++) live[i] = xmalloc(64);
+    text = repeat("abcdefghijklmnopqrstuvwxyz", STRING_LENGTH);
+    for (int i = 0; i < ARRAY_LENGTH; i++) {
+        ints[i] = i_rnd(1000000);
+        doubles[i] = d_rnd(1000);
+        strings[i] = "hello";
+    }
+    String s = repeat("0123456789abcdef\n", 4 * 1024);
+    create_temp_file(small_file, s);
+    free(s);
+    s = repeat("0123456789abcdef\n", 4 * 1024 * 1024);
+    create_temp_file(large_file, s);
+    free(s);
+    s = repeat("a line of input of typical length\n", 34 * INPUT_LINES);
+    create_temp_file(input_file, s);
+    free(s);
+    panic_if(freopen(input_file, "r", stdin) == NULL, "cannot open %s", input_file);
+
+    int status = bench_main(argc, argv);
+
+    unlink(small_file);
+    unlink(large_file);
+    unlink(input_file);
+    free(text);
+    for (int i = LIVE_BLOCKS - 1; i >= 0; i--) free(live[i]);
+    return status;
+}
@@ -0,0 +1,88 @@
+/*
+Compile: make timing
+Run: ./timing 10000000
+
+Measures the overhead of the timing functions by calling each of them the
+given number of times in a row, and their resolution as the smallest
+nonzero difference between two consecutive calls. Then prints the
+distribution of the differences between consecutive calls of time_ns,
+which shows how often a call is delayed, e.g., by an interrupt.
+*/
+
+#include "base.h"
+#include "histogram.h"
+
+static void report(String method, int n, int64_t ns, double resolution_ns) {
+    printf("%-16s %8.2f ns/call   resolution %8.2f ns\n", method, (double)ns / n, resolution_ns);
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc != 2, "usage: %s iterations", argv[0]);
+    int n = i_of_s(argv[1]);
+    panic_if(n <= 0, "iterations must be positive");
+    printf("cycle counter: %.3f cycles/ns\n", cycles_per_ns());
+
+    int64_t start = time_ns();
+    int64_t sum = 0;
+    for (int i = 0; i < n; i++) sum += clock();
+    int64_t ns = time_ns_since(start);
+    int64_t resolution = INT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        int64_t a = clock(), b;
+        while ((b = clock()) == a) {}
+        if (b - a < resolution) resolution = b - a;
+    }
+    report("clock", n, ns, resolution * 1e9 / CLOCKS_PER_SEC);
+
+    start = time_ns();
+    for (int i = 0; i < n; i++) sum += time_now().tv_nsec;
+    ns = time_ns_since(start);
+    resolution = INT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        timespec a = time_now(), b;
+        while (time_ns_between(a, b = time_now()) == 0) {}
+        if (time_ns_between(a, b) < resolution) resolution = time_ns_between(a, b);
+    }
+    report("time_now", n, ns, resolution);
+
+    start = time_ns();
+    for (int i = 0; i < n; i++) sum += time_ns();
+    ns = time_ns_since(start);
+    resolution = INT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        int64_t a = time_ns(), b;
+        while ((b = time_ns()) == a) {}
+        if (b - a < resolution) resolution = b - a;
+    }
+    report("time_ns", n, ns, resolution);
+
+    start = time_ns();
+    for (int i = 0; i < n; i++) sum += cycles_now();
+    ns = time_ns_since(start);
+    resolution = INT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        int64_t a = cycles_now(), b;
+        while ((b = cycles_now()) == a) {}
+        if (b - a < resolution) resolution = b - a;
+    }
+    report("cycles_now", n, ns, ns_of_cycles(resolution));
+
+    Histogram *h = hist_new(HIST_HOUR_NS, 3);
+    int64_t a = time_ns();
+    for (int i = 0; i < n; i++) {
+        int64_t b = time_ns();
+        hist_record(h, b - a);
+        a = b;
+    }
+    printf("time_ns intervals: ");
+    hist_print(stdout, h);
+    size_t size;
+    Byte *data = hist_encode(h, &size);
+    printf("histogram: %lu bytes in memory, %lu bytes encoded\n",
+            (unsigned long)(h->n_counts * sizeof(int64_t)), (unsigned long)size);
+    free(data);
+    hist_free(h);
+
+    printf("(checksum %lld)\n", (long long)sum);
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+Compile: make tracing
+Run: ./tracing trace.json
+
+Measures the cost of a span with tracing off and on, and of an empty
+loop for comparison. Then traces a small computation on two threads and
+writes the trace to the given file, to be opened in chrome://tracing or
+https://ui.perfetto.dev.
+*/
+
+#include <pthread.h>
+#include "base.h"
+#include "bench.h"
+#include "trace.h"
+
+BENCHMARK(empty_loop) {
+    for (int64_t i = 0; i < iterations; i++) {
+        bench_clobber();
+    }
+}
+
+BENCHMARK(span_off) {
+    trace_disable();
+    for (int64_t i = 0; i < iterations; i++) {
+        TRACE_BEGIN("span");
+        TRACE_END();
+    }
+}
+
+BENCHMARK(span_on) {
+    trace_enable(NULL);
+    for (int64_t i = 0; i < iterations; i++) {
+        TRACE_BEGIN("span");
+        TRACE_END();
+    }
+    trace_disable();
+}
+
+BENCHMARK(scope_on) {
+    trace_enable(NULL);
+    for (int64_t i = 0; i < iterations; i++) {
+        TRACE_SCOPE("scope");
+        bench_clobber();
+    }
+    trace_disable();
+}
+
+static double sum_of_roots(int n) {
+    TRACE_SCOPE("sum_of_roots");
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += sqrt(i);
+    return sum;
+}
+
+static void *work(void *arg) {
+    TRACE_SCOPE("work");
+    double sum = 0;
+    for (int k = 1; k <= 10; k++) sum += sum_of_roots(k * 100000);
+    *(double*)arg = sum;
+    return NULL;
+}
+
+int main(int argc, String argv[]) {
+    panic_if(argc < 2, "usage: %s trace.json [benchmark options]", argv[0]);
+    String file = argv[1];
+    argv[1] = argv[0];
+    int status = bench_main(argc - 1, argv + 1);
+
+    trace_clear();
+    trace_enable(NULL);
+    TRACE_BEGIN("main");
+    pthread_t thread;
+    double sums[2];
+    pthread_create(&thread, NULL, work, &sums[0]);
+    work(&sums[1]);
+    pthread_join(thread, NULL);
+    TRACE_END();
+    trace_write(file);
+    printf("sums %g %g, trace written to %s\n", sums[0], sums[1], file);
+    return status;
+}
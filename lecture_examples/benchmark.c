@@ -0,0 +1,52 @@
+/*
+Compile: make benchmark
+Run: ./benchmark
+make benchmark && ./benchmark --format=json
+
+Compares linear and binary search in a sorted array with the benchmark
+harness of bench.h.
+*/
+
+#include "base.h"
+#include "bench.h"
+
+#define N 1000
+
+static int a[N];
+
+static int linear_search(int *a, int n, int x) {
+    for (int i = 0; i < n; i++) {
+        if (a[i] == x) return i;
+    }
+    return -1;
+}
+
+static int binary_search(int *a, int n, int x) {
+    int low = 0, high = n - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (a[middle] < x) low = middle + 1;
+        else if (a[middle] > x) high = middle - 1;
+        else return middle;
+    }
+    return -1;
+}
+
+BENCHMARK(linear_search) {
+    for (int64_t i = 0; i < iterations; i++) {
+        int j = linear_search(a, N, i % N);
+        bench_do_not_optimize(j);
+    }
+}
+
+BENCHMARK(binary_search) {
+    for (int64_t i = 0; i < iterations; i++) {
+        int j = binary_search(a, N, i % N);
+        bench_do_not_optimize(j);
+    }
+}
+
+int main(int argc, String argv[]) {
+    for (int i = 0; i < N; i++) a[i] = i;
+    return bench_main(argc, argv);
+}
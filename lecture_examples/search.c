@@ -108,15 +108,14 @@ int main(void) {
     int* a = xmalloc(n * sizeof(int));
     for (int i = 0; i < n; i++) a[i] = i;
 
-    clock_t t = clock();
+    timespec t = time_now();
     int sum = 0;
     for (int i = 0; i < n; i++) {
         int j = binary_search(a, n, i);
         sum += j;
     }
     printiln(sum);
-    t = clock() - t;
-    printf("time: %g ms\n", t * 1000.0 / CLOCKS_PER_SEC);
+    printf("time: %g ms\n", time_ms_since(t));
     
     return 0;
 }
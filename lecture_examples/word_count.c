@@ -0,0 +1,33 @@
+/*
+Compile: make word_count
+Run: ./word_count example.txt
+make word_count && ./word_count < example.txt
+
+Counts lines, words, and characters like the wc command: of each file given
+as an argument, or of standard input if there is none.
+*/
+
+#include "base.h"
+#include "count.h"
+
+void print_counts(TextCounts c, String name) {
+    printf("%8lu %8lu %8lu %s\n",
+        (unsigned long)c.lines, (unsigned long)c.words, (unsigned long)c.chars, name);
+}
+
+int main(int argc, String argv[]) {
+    if (argc < 2) {
+        print_counts(count_fd(0), "");
+        return 0;
+    }
+    TextCounts total = make_text_counts();
+    for (int i = 1; i < argc; i++) {
+        TextCounts c = count_file(argv[i]);
+        print_counts(c, argv[i]);
+        total.lines += c.lines;
+        total.words += c.words;
+        total.chars += c.chars;
+    }
+    if (argc > 2) print_counts(total, "total");
+    return 0;
+}
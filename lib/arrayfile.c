@@ -0,0 +1,229 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "arrayfile.h"
+#include "checksum.h"
+#include "stream.h"
+
+// Header of an array file. The header fields and the elements are in the
+// byte order given by little_endian.
+typedef struct ArrayHeader {
+    char magic[8];
+    uint8_t version;
+    uint8_t type;
+    uint8_t element_size;
+    uint8_t little_endian; // 1 if little endian, 0 if big endian
+    uint32_t reserved;
+    uint64_t count; // number of elements
+    uint64_t checksum; // checksum64 of the element bytes, as stored in the file
+    Byte padding[32]; // the elements start at offset 64
+} ArrayHeader;
+
+#define ARRAY_MAGIC "PROG1ARR"
+#define ARRAY_VERSION 1
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NATIVE_LITTLE_ENDIAN 1
+#else
+#define NATIVE_LITTLE_ENDIAN 0
+#endif
+
+int element_size(ElementType type) {
+    switch (type) {
+        case ELEMENT_BYTE: return sizeof(Byte);
+        case ELEMENT_INT: return sizeof(int);
+        case ELEMENT_DOUBLE: return sizeof(double);
+        default: return 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Byte order
+
+static void swap_bytes(Byte *p, size_t count, int size) {
+    if (size == 4) {
+        uint32_t *q = (uint32_t*)p;
+        for (size_t i = 0; i < count; i++) q[i] = __builtin_bswap32(q[i]);
+    } else if (size == 8) {
+        uint64_t *q = (uint64_t*)p;
+        for (size_t i = 0; i < count; i++) q[i] = __builtin_bswap64(q[i]);
+    }
+}
+
+static void swap_header(ArrayHeader *h) {
+    h->count = __builtin_bswap64(h->count);
+    h->checksum = __builtin_bswap64(h->checksum);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Writing and reading
+
+void write_array_file(String name, ElementType type, const void *data, size_t count) {
+    require_not_null(name);
+    require("valid element type", element_size(type) > 0);
+    require("data not null", data != NULL || count == 0);
+    size_t n = count * element_size(type);
+    ArrayHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, ARRAY_MAGIC, sizeof(h.magic));
+    h.version = ARRAY_VERSION;
+    h.type = type;
+    h.element_size = element_size(type);
+    h.little_endian = NATIVE_LITTLE_ENDIAN;
+    h.count = count;
+    h.checksum = checksum64(data, n);
+    FileWriter *w = fw_open(name, FW_ATOMIC, 0);
+    fw_write(w, &h, sizeof(h));
+    if (n > 0) fw_write(w, data, n);
+    fw_close(w);
+}
+
+// Checks the header and converts it to native byte order. Returns whether
+// the elements need to be converted to native byte order.
+static bool check_header(String function, String name, ArrayHeader *h, ElementType type, size_t file_size) {
+    if (file_size < sizeof(ArrayHeader) || memcmp(h->magic, ARRAY_MAGIC, sizeof(h->magic)) != 0) {
+        fprintf(stderr, "%s: %s is not an array file\n", function, name);
+        base_exit(EXIT_FAILURE);
+    }
+    if (h->version != ARRAY_VERSION) {
+        fprintf(stderr, "%s: %s has unknown version %d\n", function, name, h->version);
+        base_exit(EXIT_FAILURE);
+    }
+    if (h->type != type || h->element_size != element_size(type)) {
+        fprintf(stderr, "%s: %s has element type %d, expected %d\n", function, name, h->type, type);
+        base_exit(EXIT_FAILURE);
+    }
+    bool swap = h->little_endian != NATIVE_LITTLE_ENDIAN;
+    if (swap) swap_header(h);
+    // a crafted count must not wrap the size around to that of the file
+    if (h->count > (SIZE_MAX - sizeof(ArrayHeader)) / h->element_size
+            || file_size != sizeof(ArrayHeader) + h->count * h->element_size) {
+        fprintf(stderr, "%s: %s has the wrong size for %lu elements\n", function, name, (unsigned long)h->count);
+        base_exit(EXIT_FAILURE);
+    }
+    return swap;
+}
+
+static void check_checksum(String function, String name, ArrayHeader *h, const Byte *data) {
+    if (checksum64(data, h->count * h->element_size) != h->checksum) {
+        fprintf(stderr, "%s: %s has a wrong checksum\n", function, name);
+        base_exit(EXIT_FAILURE);
+    }
+}
+
+// Reads exactly n bytes, exits on error or premature end of file.
+static void read_fully(String function, String name, int fd, Byte *p, size_t n) {
+    while (n > 0) {
+        ssize_t k = read(fd, p, n < (1 << 30) ? n : (1 << 30));
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) {
+            fprintf(stderr, "%s: Cannot read %s\n", function, name);
+            base_exit(EXIT_FAILURE);
+        }
+        p += k;
+        n -= k;
+        base_metric_add(BASE_METRIC_BYTES_READ, k);
+    }
+}
+
+Any read_array_file(String name, ElementType type, size_t *count) {
+    require_not_null(name);
+    require("valid element type", element_size(type) > 0);
+    require_not_null(count);
+    String function = "read_array_file";
+    int fd = open(name, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "%s: Cannot open %s\n", function, name);
+        base_exit(EXIT_FAILURE);
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    ArrayHeader h;
+    memset(&h, 0, sizeof(h));
+    if ((size_t)st.st_size >= sizeof(h)) read_fully(function, name, fd, (Byte*)&h, sizeof(h));
+    bool swap = check_header(function, name, &h, type, st.st_size);
+    size_t n = h.count * h.element_size;
+    Byte *data = xmalloc(n > 0 ? n : 1);
+    read_fully(function, name, fd, data, n);
+    close(fd);
+    check_checksum(function, name, &h, data);
+    if (swap) swap_bytes(data, h.count, h.element_size);
+    *count = h.count;
+    return data;
+}
+
+MappedArray map_array_file(String name, ElementType type, bool verify) {
+    require_not_null(name);
+    require("valid element type", element_size(type) > 0);
+    String function = "map_array_file";
+    MappedArray a;
+    a.file = map_file(name, verify ? ADVICE_SEQUENTIAL : ADVICE_NORMAL);
+    ArrayHeader h;
+    memset(&h, 0, sizeof(h));
+    if (a.file.size >= sizeof(h)) memcpy(&h, a.file.data, sizeof(h));
+    if (check_header(function, name, &h, type, a.file.size)) {
+        fprintf(stderr, "%s: %s has a different byte order, read it with read_array_file\n", function, name);
+        base_exit(EXIT_FAILURE);
+    }
+    if (verify) {
+        check_checksum(function, name, &h, a.file.data + sizeof(h));
+        advise_mapped_file(&a.file, ADVICE_NORMAL);
+    }
+    a.type = type;
+    a.count = h.count;
+    a.data = a.file.data + sizeof(h);
+    return a;
+}
+
+void unmap_array_file(MappedArray *a) {
+    require_not_null(a);
+    unmap_file(&a->file);
+    a->count = 0;
+    a->data = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Typed arrays
+
+void ia_write_binary(String name, int *a, int n) {
+    require("non-negative length", n >= 0);
+    write_array_file(name, ELEMENT_INT, a, n);
+}
+
+int *ia_read_binary(String name, int *n) {
+    require_not_null(n);
+    size_t count;
+    int *a = read_array_file(name, ELEMENT_INT, &count);
+    if (count > INT_MAX) {
+        fprintf(stderr, "%s: %s has more than INT_MAX elements\n", (String)__func__, name);
+        base_exit(EXIT_FAILURE);
+    }
+    *n = count;
+    return a;
+}
+
+void da_write_binary(String name, double *a, int n) {
+    require("non-negative length", n >= 0);
+    write_array_file(name, ELEMENT_DOUBLE, a, n);
+}
+
+double *da_read_binary(String name, int *n) {
+    require_not_null(n);
+    size_t count;
+    double *a = read_array_file(name, ELEMENT_DOUBLE, &count);
+    if (count > INT_MAX) {
+        fprintf(stderr, "%s: %s has more than INT_MAX elements\n", (String)__func__, name);
+        base_exit(EXIT_FAILURE);
+    }
+    *n = count;
+    return a;
+}
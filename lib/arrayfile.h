@@ -0,0 +1,132 @@
+/** @file
+Binary array files. An array file stores the elements of an array in binary form, after a small header with the element type, the number of elements, the byte order, and a checksum of the elements. Unlike text files written with @ref printia and parsed with @ref i_of_s, array files are saved and loaded without converting numbers, and can be mapped into memory without copying.
+
+Example: Save and load an int array.
+@code{.c}
+int a[] = { 1, 2, 3 };
+ia_write_binary("a.bin", a, 3);
+int n;
+int *b = ia_read_binary("a.bin", &n);
+printialn(b, n); // [1, 2, 3]
+free(b);
+@endcode
+
+Example: Map a double array into memory.
+@code{.c}
+MappedArray m = map_array_file("d.bin", ELEMENT_DOUBLE, false);
+double sum = 0;
+for (size_t i = 0; i < m.count; i++) sum += m.doubles[i];
+unmap_array_file(&m);
+@endcode
+
+The elements start at offset 64 of the file, such that mapped elements are aligned. Files written on a machine with a different byte order are converted by the copying readers. The functions exit the program if a file cannot be read, has the wrong element type, or has a wrong checksum.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __ARRAYFILE_H__
+#define __ARRAYFILE_H__
+
+#include "base.h"
+#include "mapfile.h"
+
+/**
+The type of the elements of an array file.
+*/
+typedef enum ElementType {
+    ELEMENT_BYTE = 1, ///< Byte, 1 byte
+    ELEMENT_INT = 2, ///< int, 4 bytes
+    ELEMENT_DOUBLE = 3 ///< double, 8 bytes
+} ElementType;
+
+/**
+An array file that is mapped into memory. The elements are read-only.
+@see map_array_file, unmap_array_file
+*/
+typedef struct MappedArray {
+    MappedFile file; ///< the mapped file, including the header
+    ElementType type; ///< type of the elements
+    size_t count; ///< number of elements
+    union {
+        const void *data; ///< the elements
+        const Byte *bytes; ///< the elements, if the type is ELEMENT_BYTE
+        const int *ints; ///< the elements, if the type is ELEMENT_INT
+        const double *doubles; ///< the elements, if the type is ELEMENT_DOUBLE
+    };
+} MappedArray;
+
+/**
+Gets the size of an element of the given type in bytes.
+@param[in] type element type
+@return the size of an element
+*/
+int element_size(ElementType type);
+
+/**
+Writes an array to a file. The file is replaced atomically, i.e., readers see either the old or the new file.
+@param[in] name file name (including path)
+@param[in] type type of the elements
+@param[in] data the elements
+@param[in] count number of elements
+*/
+void write_array_file(String name, ElementType type, const void *data, size_t count);
+
+/**
+Reads the elements of an array file into a newly allocated array.
+@param[in] name file name (including path)
+@param[in] type expected type of the elements
+@param[out] count number of elements
+@return the elements, free them with @ref free
+*/
+Any read_array_file(String name, ElementType type, size_t *count);
+
+/**
+Maps the elements of an array file into memory, without copying them.
+@param[in] name file name (including path)
+@param[in] type expected type of the elements
+@param[in] verify if @c true, checks the checksum, which reads the whole file
+@return the mapped array, unmap it with @ref unmap_array_file
+*/
+MappedArray map_array_file(String name, ElementType type, bool verify);
+
+/**
+Unmaps a mapped array file.
+@param[in,out] a the mapped array
+*/
+void unmap_array_file(MappedArray *a);
+
+/**
+Writes an int array to an array file.
+@param[in] name file name (including path)
+@param[in] a the array
+@param[in] n number of elements
+*/
+void ia_write_binary(String name, int *a, int n);
+
+/**
+Reads an int array from an array file.
+@param[in] name file name (including path)
+@param[out] n number of elements
+@return the array, free it with @ref free
+*/
+int *ia_read_binary(String name, int *n);
+
+/**
+Writes a double array to an array file.
+@param[in] name file name (including path)
+@param[in] a the array
+@param[in] n number of elements
+*/
+void da_write_binary(String name, double *a, int n);
+
+/**
+Reads a double array from an array file.
+@param[in] name file name (including path)
+@param[out] n number of elements
+@return the array, free it with @ref free
+*/
+double *da_read_binary(String name, int *n);
+
+#endif
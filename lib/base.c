@@ -4,6 +4,11 @@
 @copyright Apache License, Version 2.0
 */
 
+#include <pthread.h>
+#include <sys/stat.h>
+#ifdef __x86_64__
+#include <x86intrin.h>
+#endif
 #include "base.h"
 #undef free // use the 'real' free here
 #undef exit // use the 'real' exit here
@@ -31,14 +36,11 @@ typedef struct BaseAllocInfo {
 
 BaseAllocInfo *base_alloc_info = NULL;
 
-void base_free(Any p) {
-#if 0
-    // debug output
-    printf("base_free: Calling free on %p\n", p);
-    for (BaseAllocInfo *dp = base_alloc_info; dp != NULL; dp = dp->next) {
-        printf("%p\n", dp->p);
-    }
-#endif
+// protects base_alloc_info, memory may be allocated on several threads
+static pthread_mutex_t base_alloc_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+bool base_untrack(Any p) {
+    pthread_mutex_lock(&base_alloc_mutex);
     bool removed = false;
     BaseAllocInfo *ai = base_alloc_info;
     if (ai != NULL) {
@@ -59,9 +61,22 @@ void base_free(Any p) {
             }
         }
     }
-    if (!removed) {
+    pthread_mutex_unlock(&base_alloc_mutex);
+    return removed;
+}
+
+void base_free(Any p) {
+#if 0
+    // debug output
+    printf("base_free: Calling free on %p\n", p);
+    for (BaseAllocInfo *dp = base_alloc_info; dp != NULL; dp = dp->next) {
+        printf("%p\n", dp->p);
+    }
+#endif
+    if (!base_untrack(p)) {
         fprintf(stderr, "base_free: trying to free unknown pointer %p\n", p);
     }
+    base_metric_add(BASE_METRIC_FREES, 1);
 
     free(p);
 }
@@ -91,6 +106,24 @@ void report_memory_leaks(bool do_check) {
     do_memory_check = do_check;
 }
 
+void base_track(const char *file, const char *function, int line, Any p, size_t size) {
+    BaseAllocInfo *ai = malloc(sizeof(BaseAllocInfo));
+    if (ai == NULL) {
+        fprintf(stderr, "%s, line %d: malloc(sizeof(BaseAllocInfo)) called in %s returned NULL!\n", 
+                file, line, (String)__func__);
+        base_exit(EXIT_FAILURE);
+    }
+    ai->p = p;
+    ai->size = size;
+    ai->file = file;
+    ai->function = function;
+    ai->line = line;
+    pthread_mutex_lock(&base_alloc_mutex);
+    ai->next = base_alloc_info;
+    base_alloc_info = ai;
+    pthread_mutex_unlock(&base_alloc_mutex);
+}
+
 Any base_malloc(const char *file, const char *function, int line, size_t size) {
     // allocate four bytes more than requested and fill with garbage, 
     // such that non-terminated strings will produce an unexpected result
@@ -106,24 +139,15 @@ Any base_malloc(const char *file, const char *function, int line, size_t size) {
     memset(p, '?', size + 3);
     ((char*)p)[size + 3] = '\0';
 
-    BaseAllocInfo *ai = malloc(sizeof(BaseAllocInfo));
-    if (ai == NULL) {
-        fprintf(stderr, "%s, line %d: malloc(sizeof(BaseAllocInfo)) called in base_malloc returned NULL!\n", 
-                file, line);
-        base_exit(EXIT_FAILURE);
-    }
-    ai->p = p;
-    ai->size = size;
-    ai->file = file;
-    ai->function = function;
-    ai->line = line;
-    ai->next = base_alloc_info;
-    base_alloc_info = ai;
-
+    base_track(file, function, line, p, size);
+    base_metric_add(BASE_METRIC_ALLOCATIONS, 1);
+    base_metric_add(BASE_METRIC_ALLOCATED_BYTES, size);
     return p;
 }
 
 Any base_realloc(const char *file, const char *function, int line, Any ptr, size_t size) {
+    // keep the lock while ptr may be freed, such that no other thread records a block at ptr
+    pthread_mutex_lock(&base_alloc_mutex);
     Any p = realloc(ptr, size);
     if (p == NULL) {
         fprintf(stderr, "%s, line %d: malloc(%lu) called in base_realloc returned NULL!\n",
@@ -142,6 +166,9 @@ Any base_realloc(const char *file, const char *function, int line, Any ptr, size
     ai->file = file;
     ai->function = function;
     ai->line = line;
+    pthread_mutex_unlock(&base_alloc_mutex);
+    base_metric_add(BASE_METRIC_ALLOCATIONS, 1);
+    base_metric_add(BASE_METRIC_ALLOCATED_BYTES, size);
     return p;
 }
 
@@ -155,19 +182,9 @@ Any base_calloc(const char *file, const char *function, int line, size_t num, si
     }
     // printf("%s, line %d: xcalloc(%lu, %lu) returned %lx\n", file, line, (unsigned long)num, (unsigned long)size, (unsigned long)p);
 
-    BaseAllocInfo *ai = malloc(sizeof(BaseAllocInfo));
-    if (ai == NULL) {
-        fprintf(stderr, "%s, line %d: malloc(sizeof(BaseAllocInfo)) called in base_calloc returned NULL!\n", 
-                file, line);
-        base_exit(EXIT_FAILURE);
-    }
-    ai->p = p;
-    ai->size = num * size;
-    ai->file = file;
-    ai->function = function;
-    ai->line = line;
-    ai->next = base_alloc_info;
-    base_alloc_info = ai;
+    base_track(file, function, line, p, num * size);
+    base_metric_add(BASE_METRIC_ALLOCATIONS, 1);
+    base_metric_add(BASE_METRIC_ALLOCATED_BYTES, num * size);
     // printf("base_calloc entered %p\n", base_alloc_info->p);
 
     return p;   
@@ -206,30 +223,11 @@ String s_copy(String s) {
     return a;
 }
 
-char s_get(String s, int i) {
-    require_not_null(s);
-    int n = strlen(s);
-    require_x("index in range", i >= 0 && i < n, "index == %d, length == %d", i, n);
-    return s[i];
-}
-
-void s_set(String s, int i, char v) {
-    require_not_null(s);
-    int n = strlen(s);
-    require_x("index in range", i >= 0 && i < n, "index == %d, length == %d", i, n);
-    s[i] = v;
-}
-
-int s_length(String s) {
-    require_not_null(s);
-    return strlen(s);
-}
-
-bool s_equals(String s, String t) {
-    require_not_null(s);
-    require_not_null(t);
-    return strcmp(s, t) == 0;
-}
+// external definitions of the inline functions of base.h
+extern char s_get(String s, int i);
+extern void s_set(String s, int i, char c);
+extern int s_length(String s);
+extern bool s_equals(String s, String t);
 
 bool s_contains(String s, String part) {
     require_not_null(s);
@@ -452,27 +450,72 @@ String s_input(int n) {
     }
 
     n = strlen(line);
-    if (n >= 1 && (line[n-1] == '\n' || line[n-1] == '\r')) line[n-1] = '\0'; 
-    if (n >= 2 && (line[n-2] == '\n' || line[n-2] == '\r')) line[n-2] = '\0'; 
-    n = strlen(line);
-    String s = base_malloc(__FILE__, __func__, __LINE__, n + 1);
-    strcpy(s, line);
-    base_free(line);
-    return s;
+    if (n >= 1 && (line[n-1] == '\n' || line[n-1] == '\r')) line[--n] = '\0'; 
+    if (n >= 1 && (line[n-1] == '\n' || line[n-1] == '\r')) line[--n] = '\0'; 
+    // shrink to the actual length, usually in place
+    return base_realloc(__FILE__, __func__, __LINE__, line, n + 1);
+}
+
+LineBuffer make_line_buffer(void) {
+    LineBuffer b = { NULL, 0, 0 };
+    return b;
+}
+
+bool read_line(LineBuffer *b, FILE *f) {
+    require_not_null(b);
+    require_not_null(f);
+    if (b->capacity < 128) {
+        b->capacity = 128;
+        b->s = base_realloc(__FILE__, __func__, __LINE__, b->s, b->capacity);
+    }
+
+    int n = 0;
+    bool found = false;
+    while (fgets(b->s + n, b->capacity - n, f) != NULL) {
+        found = true;
+        n += strlen(b->s + n);
+        // a chunk that starts with a null byte has length 0, it ends the line as well
+        if (n == 0 || b->s[n-1] == '\n' || n < b->capacity - 1) break; // end of line or end of file
+        // line does not fit, double the buffer and continue reading
+        b->capacity *= 2;
+        b->s = base_realloc(__FILE__, __func__, __LINE__, b->s, b->capacity);
+    }
+    if (ferror(f)) {
+        fprintf(stderr, "%s: Cannot read from file.\n", (String)__func__); 
+        base_exit(EXIT_FAILURE);
+    }
+
+    if (n >= 1 && b->s[n-1] == '\n') n--;
+    if (n >= 1 && b->s[n-1] == '\r') n--;
+    b->s[n] = '\0';
+    b->length = n;
+    return found;
+}
+
+void free_line_buffer(LineBuffer *b) {
+    require_not_null(b);
+    if (b->s != NULL) base_free(b->s);
+    *b = make_line_buffer();
+}
+
+// Reads a short line into a buffer on the stack, no dynamic memory involved.
+static void input_number_line(char *line, int n, const char *function) {
+    if (fgets(line, n, stdin) == NULL) {
+        fprintf(stderr, "%s has failed: fgets() returned NULL!\n", function);
+        exit(EXIT_FAILURE);
+    }
 }
 
 int i_input(void) {
-    String s = s_input(100);
-    int i = i_of_s(s);
-    free(s);
-    return i;
+    char line[100];
+    input_number_line(line, sizeof(line), __func__);
+    return atoi(line);
 }
 
 double d_input(void) {
-    String s = s_input(100);
-    double d = d_of_s(s);
-    free(s);
-    return d;
+    char line[100];
+    input_number_line(line, sizeof(line), __func__);
+    return atof(line);
 }
 
 
@@ -480,36 +523,57 @@ double d_input(void) {
 ////////////////////////////////////////////////////////////////////////////
 // Files
 
-String s_read_file(String name) {
+// Reads the whole file into a newly allocated, zero-terminated buffer. Uses the 
+// file size if it is known. Otherwise, e.g., for pipes and files in /proc, 
+// grows the buffer geometrically.
+static char *read_whole_file(const char *function, String name, String mode, size_t *n) {
     require_not_null(name);
     
-    FILE *f = fopen(name, "r"); // removes \r from read content, only leaves \n
+    FILE *f = fopen(name, mode);
     if (f == NULL) {
-        fprintf(stderr, "%s: Cannot open %s\n", (String)__func__, name); 
+        fprintf(stderr, "%s: Cannot open %s\n", function, name); 
         base_exit(EXIT_FAILURE);
     }
-    fseek (f, 0, SEEK_END);
-    long size = ftell(f);
-    rewind(f);
-    
-    char *s = base_malloc(__FILE__, __func__, __LINE__, size + 1);
-    if (s == NULL) {
-        fprintf(stderr, "%s: Cannot allocate memory.\n", (String)__func__); 
+    size_t capacity = 64 * 1024;
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        capacity = (size_t)st.st_size + 1; // + 1 for '\0' termination
+    }
+
+    char *s = base_malloc(__FILE__, function, __LINE__, capacity);
+    size_t size = 0;
+    for (;;) {
+        size += fread(s + size, 1, capacity - 1 - size, f);
+        if (size < capacity - 1) break; // end of file or error
+        // buffer is full, check for more data
+        int c = getc(f);
+        if (c == EOF) break;
+        s[size++] = c;
+        capacity *= 2;
+        s = base_realloc(__FILE__, function, __LINE__, s, capacity);
+    }
+    if (ferror(f)) {
+        fprintf(stderr, "%s: Cannot read file %s to end.\n", function, name); 
         base_exit(EXIT_FAILURE);
     }
-    long sizeRead = fread(s, 1, size, f);
-    // assert: size >= sizeRead (> if file contains \r characters)
-    // printf("size = %lu, sizeRead = %lu, feof = %d\n", size, sizeRead, feof(f));
-    if (sizeRead < size && feof(f) == 0) {
-        fprintf(stderr, "%s: Cannot read file %s to end.\n", (String)__func__, name); 
-        base_exit(EXIT_FAILURE);
-    }
-    s[sizeRead] = '\0';
+    s[size] = '\0';
+    base_metric_add(BASE_METRIC_BYTES_READ, size);
     
     fclose(f);
+    *n = size;
     return s;
 }
 
+String s_read_file(String name) {
+    size_t n;
+    return read_whole_file(__func__, name, "r", &n); // "r" removes \r from read content, only leaves \n
+}
+
+Byte *read_file_data(String name, size_t *n) {
+    require_not_null(n);
+    return (Byte*)read_whole_file(__func__, name, "rb", n);
+}
+
 void s_write_file(String name, String data) {
     require_not_null(name);
     require_not_null(data);
@@ -526,14 +590,17 @@ void s_write_file(String name, String data) {
         fprintf(stderr, "%s: Cannot write data to file %s.\n", (String)__func__, name); 
         base_exit(EXIT_FAILURE);
     }
+    base_metric_add(BASE_METRIC_BYTES_WRITTEN, n_written);
     
-    fclose(f);
+    if (fclose(f) != 0) { // buffered data may only be written when closing
+        fprintf(stderr, "%s: Cannot write data to file %s.\n", (String)__func__, name); 
+        base_exit(EXIT_FAILURE);
+    }
 }
 
-void write_file_data(String name, Byte *data, int n_data) {
+void write_file_data(String name, Byte *data, size_t n_data) {
     require_not_null(name);
     require_not_null(data);
-    require("non-negative length", n_data >= 0);
 
     FILE *f = fopen(name, "w");
     if (f == NULL) {
@@ -546,14 +613,18 @@ void write_file_data(String name, Byte *data, int n_data) {
         fprintf(stderr, "%s: Cannot write data to file %s.\n", (String)__func__, name); 
         base_exit(EXIT_FAILURE);
     }
+    base_metric_add(BASE_METRIC_BYTES_WRITTEN, n_written);
     
-    fclose(f);
+    if (fclose(f) != 0) { // buffered data may only be written when closing
+        fprintf(stderr, "%s: Cannot write data to file %s.\n", (String)__func__, name); 
+        base_exit(EXIT_FAILURE);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // Time taking
 // https://en.cppreference.com/w/c/chrono/clock
-/*
+
 timespec time_now(void) {
     timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
@@ -561,13 +632,60 @@ timespec time_now(void) {
 }
 
 double time_ms_since(timespec t) {
+    return 1e-6 * time_ns_between(t, time_now());
+}
+
+double time_s_since(timespec t) {
+    return 1e-9 * time_ns_between(t, time_now());
+}
+
+int64_t time_ns_between(timespec from, timespec to) {
+    // integer arithmetic, doubles would lose nanoseconds after a few months of uptime
+    return (int64_t)(to.tv_sec - from.tv_sec) * 1000000000 + (to.tv_nsec - from.tv_nsec);
+}
+
+int64_t time_ns(void) {
     timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
-    double duration =  1000.0 * now.tv_sec + 1e-6 * now.tv_nsec
-                     - (1000.0 * t.tv_sec + 1e-6*t.tv_nsec);
-    return duration;
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+int64_t time_ns_since(int64_t start) {
+    return time_ns() - start;
+}
+
+int64_t cycles_now(void) {
+#ifdef __x86_64__
+    return (int64_t)__rdtsc();
+#else
+    return time_ns();
+#endif
+}
+
+static double cycles_per_nanosecond = 0;
+static pthread_once_t cycles_calibrated = PTHREAD_ONCE_INIT;
+
+// Counts cycles while the monotonic clock advances by 10 ms. Waits actively,
+// since the counter might not advance while sleeping on some processors.
+static void calibrate_cycles(void) {
+    int64_t t0 = time_ns();
+    int64_t c0 = cycles_now();
+    int64_t t1;
+    do {
+        t1 = time_ns();
+    } while (t1 - t0 < 10000000);
+    int64_t c1 = cycles_now();
+    cycles_per_nanosecond = (double)(c1 - c0) / (t1 - t0);
+}
+
+double cycles_per_ns(void) {
+    pthread_once(&cycles_calibrated, calibrate_cycles);
+    return cycles_per_nanosecond;
+}
+
+double ns_of_cycles(int64_t cycles) {
+    return cycles / cycles_per_ns();
 }
-*/
 
 ////////////////////////////////////////////////////////////////////////////
 // Random numbers
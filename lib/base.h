@@ -85,6 +85,7 @@ See test functions in .c file for more examples.
 #include <math.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
 // #include <execinfo.h> // stack traces
 #include "basedefs.h"
 
@@ -106,6 +107,57 @@ void report_memory_leaks(bool do_check);
 
 
 
+////////////////////////////////////////////////////////////////////////////
+// Metrics
+
+/**
+The metrics that the library itself updates: checked contracts (preconditions and postconditions), memory allocations, and bytes read and written by the file functions. They are reported with the other metrics of metrics.h.
+@private
+*/
+typedef enum BaseMetric {
+    BASE_METRIC_CONTRACT_CHECKS, ///< number of executed preconditions and postconditions
+    BASE_METRIC_ALLOCATIONS, ///< number of calls of xmalloc, xcalloc, and xrealloc
+    BASE_METRIC_ALLOCATED_BYTES, ///< number of bytes requested from xmalloc, xcalloc, and xrealloc
+    BASE_METRIC_FREES, ///< number of calls of free
+    BASE_METRIC_BYTES_READ, ///< number of bytes read from files
+    BASE_METRIC_BYTES_WRITTEN, ///< number of bytes written to files
+    BASE_METRICS ///< number of library metrics
+} BaseMetric;
+
+/**
+The metric values of the calling thread, NULL before the first update.
+@private
+*/
+extern __thread int64_t *base_metric_cells;
+
+/**
+Allocates the metric values of the calling thread, or enlarges them to include metrics registered since. They are freed when the thread ends.
+@return the metric values of the calling thread
+@private
+*/
+int64_t *base_metric_thread_cells(void);
+
+/**
+Adds to a metric of the calling thread. Only this thread writes its values, so no locks or atomic read-modify-write instructions are needed.
+@param[in] cell the index of the metric value
+@param[in] n the value to add
+@private
+*/
+static inline void base_metric_add(int cell, int64_t n) {
+    int64_t *cells = base_metric_cells;
+    if (cells == NULL) cells = base_metric_thread_cells();
+    // other threads read the value when reporting
+    __atomic_store_n(&cells[cell], cells[cell] + n, __ATOMIC_RELAXED);
+}
+
+/**
+Counts an executed contract check. A macro rather than a call of @ref base_metric_add, because debug builds do not inline and the contracts are everywhere. Checks before the first metric update of a thread are not counted.
+@private
+*/
+#define base_count_contract() \
+    (base_metric_cells == NULL ? (void)base_metric_thread_cells() : (void)__atomic_store_n(\
+        &base_metric_cells[BASE_METRIC_CONTRACT_CHECKS], base_metric_cells[BASE_METRIC_CONTRACT_CHECKS] + 1, __ATOMIC_RELAXED))
+
 ////////////////////////////////////////////////////////////////////////////
 // Assertions
 
@@ -252,7 +304,7 @@ Example output of failed preconditions:
 @param[in] condition boolean the condition to check
 */
 #define require(description, condition) \
-if (!(condition)) {\
+if ((base_count_contract(), !(condition))) {\
     fprintf(stderr, "%s, line %d: %s's precondition \"%s\" (%s) violated\n", __FILE__, __LINE__, __func__, description, #condition);\
     exit(EXIT_FAILURE);\
 }
@@ -281,7 +333,7 @@ Example output of failed preconditions:
 @param[in] condition boolean the condition to check
 */
 #define require_x(description, condition, ...) \
-if (!(condition)) {\
+if ((base_count_contract(), !(condition))) {\
     fprintf(stderr, "%s, line %d: %s's precondition \"%s\" violated: ", __FILE__, __LINE__, __func__, description);\
     fprintf(stderr, __VA_ARGS__);\
     fprintf(stderr, "\n");\
@@ -295,7 +347,7 @@ if (!(condition)) {\
 
 #include <execinfo.h>
 #define require_x(description, condition, ...) \
-if (!(condition)) {\
+if ((base_count_contract(), !(condition))) {\
     fprintf(stderr, "%s, line %d: %s's precondition \"%s\" violated: ", __FILE__, __LINE__, __func__, description);\
     fprintf(stderr, __VA_ARGS__);\
     fprintf(stderr, "\n");\
@@ -335,10 +387,40 @@ Example output of failed preconditions:
 @param[in] argument pointer a pointer that must not be null
 */
 #define require_not_null(argument) \
+if ((base_count_contract(), argument == NULL)) {\
+    fprintf(stderr, "%s, line %d: %s's precondition \"not null\" (" #argument ") violated\n", __FILE__, __LINE__, __func__);\
+    exit(EXIT_FAILURE);\
+}
+#endif
+
+#ifdef NO_REQUIRE
+#define require_not_null_uncounted(argument)
+#define require_x_uncounted(description, condition, ...)
+#else
+/**
+Like @ref require_not_null, but the check is not counted in the metrics. For the inline functions of this header: Updating the counter in a loop prevents vectorizing the loop.
+@param[in] argument pointer a pointer that must not be null
+@private
+*/
+#define require_not_null_uncounted(argument) \
 if (argument == NULL) {\
     fprintf(stderr, "%s, line %d: %s's precondition \"not null\" (" #argument ") violated\n", __FILE__, __LINE__, __func__);\
     exit(EXIT_FAILURE);\
 }
+
+/**
+Like @ref require_x, but not counted, see @ref require_not_null_uncounted.
+@param[in] description String a description of the condition that has to be valid
+@param[in] condition boolean the condition to check
+@private
+*/
+#define require_x_uncounted(description, condition, ...) \
+if (!(condition)) {\
+    fprintf(stderr, "%s, line %d: %s's precondition \"%s\" violated: ", __FILE__, __LINE__, __func__, description);\
+    fprintf(stderr, __VA_ARGS__);\
+    fprintf(stderr, "\n");\
+    exit(EXIT_FAILURE);\
+}
 #endif
 
 
@@ -368,7 +450,7 @@ Example output of failed postconditions:
 @param[in] condition boolean the condition to check
 */
 #define ensure(description, condition) \
-if (!(condition)) {\
+if ((base_count_contract(), !(condition))) {\
     fprintf(stderr, "%s, line %d: %s's postcondition \"%s\" (%s) violated\n", __FILE__, __LINE__, __func__, description, #condition);\
     exit(EXIT_FAILURE);\
 }
@@ -400,7 +482,7 @@ Example output of failed postconditions:
 @param[in] condition boolean the condition to check
 */
 #define ensure_x(description, condition, ...) \
-if (!(condition)) {\
+if ((base_count_contract(), !(condition))) {\
     fprintf(stderr, "%s, line %d: %s's postcondition \"%s\" violated: ", __FILE__, __LINE__, __func__, description);\
     fprintf(stderr, __VA_ARGS__);\
     fprintf(stderr, "\n");\
@@ -447,7 +529,7 @@ Example output of failed postcondition:
 @param[in] pointer a pointer that must not be null
 */
 #define ensure_not_null(pointer) \
-if (pointer == NULL) {\
+if ((base_count_contract(), pointer == NULL)) {\
     fprintf(stderr, "%s, line %d: %s's postcondition \"not null\" (" #pointer ") violated\n", __FILE__, __LINE__, __func__);\
     exit(EXIT_FAILURE);\
 }
@@ -593,16 +675,94 @@ if (condition) {\
 ////////////////////////////////////////////////////////////////////////////
 // Timing
 
-/*
-/// A structure for storing time values.
+/**
+A structure for storing time values.
+*/
 typedef struct timespec timespec;
 
-/// Gets the current time.
+/**
+Gets the current time of the monotonic clock. This clock is not affected by changes of the system time, so it is suitable for measuring durations.
+@return the current time
+*/
 timespec time_now(void);
 
-/// Computes the time difference in milliseconds between now and the given time.
+/**
+Computes the time difference in milliseconds between now and the given time.
+
+Example:
+@code{.c}
+timespec start = time_now();
+do_work();
+printf("%.3f ms\n", time_ms_since(start));
+@endcode
+
+@param[in] t a time obtained from @ref time_now
+@return the milliseconds since @c t
+*/
 double time_ms_since(timespec t);
+
+/**
+Computes the time difference in seconds between now and the given time.
+@param[in] t a time obtained from @ref time_now
+@return the seconds since @c t
 */
+double time_s_since(timespec t);
+
+/**
+Computes the time difference in nanoseconds between two times.
+@param[in] from the earlier time
+@param[in] to the later time
+@return the nanoseconds from @c from to @c to (negative if @c to is before @c from)
+*/
+int64_t time_ns_between(timespec from, timespec to);
+
+/**
+Gets the current time of the monotonic clock in nanoseconds. Only differences between two such values are meaningful. This is a cheaper way to measure a duration than @ref time_now, since no structure needs to be converted.
+
+Example:
+@code{.c}
+int64_t start = time_ns();
+do_work();
+printf("%lld ns\n", (long long)time_ns_since(start));
+@endcode
+
+@return nanoseconds since an arbitrary, fixed point in the past
+*/
+int64_t time_ns(void);
+
+/**
+Computes the time difference in nanoseconds between now and the given time.
+@param[in] start a time obtained from @ref time_ns
+@return the nanoseconds since @c start
+*/
+int64_t time_ns_since(int64_t start);
+
+/**
+Reads the cycle counter of the processor. On x86-64 this is the time stamp counter (TSC), which modern processors increment at a constant rate, independent of the current clock frequency. Reading it takes only a few nanoseconds, so it is suited for timing very short regions. On other processors, this returns @ref time_ns. Use @ref ns_of_cycles to convert a difference of two counter values to nanoseconds.
+
+Example:
+@code{.c}
+int64_t c = cycles_now();
+short_region();
+printf("%.1f ns\n", ns_of_cycles(cycles_now() - c));
+@endcode
+
+@return the current value of the cycle counter
+*/
+int64_t cycles_now(void);
+
+/**
+Gets the rate of the cycle counter. The rate is measured against the monotonic clock on the first call, which takes about 10 milliseconds. Later calls return the same value.
+@return the number of counter increments per nanosecond
+*/
+double cycles_per_ns(void);
+
+/**
+Converts a difference of two values of @ref cycles_now to nanoseconds.
+@param[in] cycles the number of counter increments
+@return the nanoseconds
+*/
+double ns_of_cycles(int64_t cycles);
 
 ////////////////////////////////////////////////////////////////////////////
 // Debugging
@@ -704,6 +864,27 @@ Our own version of free. Keeps track of allocated blocks for error reporting.
 */
 void base_free(Any p);
 
+/**
+Records a memory block that has not been allocated with @ref xmalloc or @ref xcalloc, e.g., a memory-mapped file, such that it is included in the memory leak report.
+@param[in] file file name of source code
+@param[in] function function name of source code
+@param[in] line line number in source code
+@param[in] p start of the memory block
+@param[in] size size of the memory block in bytes
+@see base_untrack
+@private
+*/
+void base_track(const char *file, const char *function, int line, Any p, size_t size);
+
+/**
+Removes a memory block from the records of allocated memory blocks, without freeing it.
+@param[in] p start of the memory block
+@return @c true if the block was recorded, @c false otherwise
+@see base_track
+@private
+*/
+bool base_untrack(Any p);
+
 /**
 Frees memory blocks allocated with @ref xmalloc or @ref xcalloc.
 @param[in] p pointer to memory block to free
@@ -734,6 +915,10 @@ Memory of copy is dynamically allocated.
 */
 String s_copy(String s);
 
+// s_get, s_set, s_length, and s_equals are inline, such that loops over the characters
+// of a String can be optimized, e.g., vectorized. base.c has their external definitions
+// for calls that are not inlined. Their checks are not counted.
+
 /**
 Returns character at index @c i.
 @param[in] s input string
@@ -741,7 +926,12 @@ Returns character at index @c i.
 @return character at index i
 @pre "index in range", i >= 0 && i < length
 */
-char s_get(String s, int i);
+inline char s_get(String s, int i) {
+    require_not_null_uncounted(s);
+    int n = strlen(s);
+    require_x_uncounted("index in range", i >= 0 && i < n, "index == %d, length == %d", i, n);
+    return s[i];
+}
 
 /** 
 Sets s element at index i to value v.
@@ -750,14 +940,22 @@ Sets s element at index i to value v.
 @param[in] c character to set
 @pre "index in range", i >= 0 && i < length
 */
-void s_set(String s, int i, char c);
+inline void s_set(String s, int i, char c) {
+    require_not_null_uncounted(s);
+    int n = strlen(s);
+    require_x_uncounted("index in range", i >= 0 && i < n, "index == %d, length == %d", i, n);
+    s[i] = c;
+}
 
 /**
 Returns the length of the string (number of characters).
 @param[in] s input string
 @return number of characters
 */
-int s_length(String s);
+inline int s_length(String s) {
+    require_not_null_uncounted(s);
+    return strlen(s);
+}
 
 /**
 Returns true iff @c s and @c t are equal.
@@ -765,7 +963,11 @@ Returns true iff @c s and @c t are equal.
 @param[in] t input string
 @return true iff @c s and @c t are equal
 */
-bool s_equals(String s, String t);
+inline bool s_equals(String s, String t) {
+    require_not_null_uncounted(s);
+    require_not_null_uncounted(t);
+    return strcmp(s, t) == 0;
+}
 
 /**
 Returns true iff @c s contains part.
@@ -871,13 +1073,74 @@ Reads at most n-1 characters into an existing buffer. Stops reading if newline o
 void get_line(char *line, int n);
 
 /**
-Reads at most n-1 characters into a newly allocated string. Stops reading if newline or end-of-file is reached. Does not return the newline character.
+Reads at most n-1 characters into a newly allocated string. Stops reading if newline or end-of-file is reached. Does not return the newline character. To read many lines or lines of unknown length, use @ref read_line.
 @param[in] n maximum number of bytes to read, has to be at least 8
 @return newly allocated String with bytes read
-@see get_line
+@see get_line, read_line
 */
 String s_input(int n);
 
+/**
+A growable buffer for reading lines of arbitrary length. The buffer is owned by the caller and reused from line to line, so reading many lines only allocates when a line is longer than all lines before. Initialize it with @ref make_line_buffer and release it with @ref free_line_buffer.
+
+Example:
+@code{.c}
+LineBuffer b = make_line_buffer();
+while (read_line(&b, stdin)) {
+    printsln(b.s);
+}
+free_line_buffer(&b);
+@endcode
+
+@see read_line, for_each_line
+*/
+typedef struct LineBuffer {
+    String s; ///< the current line, zero-terminated, without line break
+    int length; ///< number of characters in @c s
+    int capacity; ///< number of bytes allocated for @c s
+} LineBuffer;
+
+/**
+Creates an empty line buffer. No memory is allocated until the first line is read.
+@return the line buffer
+@see read_line, free_line_buffer
+*/
+LineBuffer make_line_buffer(void);
+
+/**
+Reads the next line from @c f into the line buffer. There is no limit on the line length, the buffer grows as needed. The line break (@c "\n" or @c "\r\n") is not stored. The last line of a file does not need to be terminated by a line break.
+@param[in,out] b line buffer to read into, @c b->s and @c b->length hold the line read
+@param[in] f file to read from, e.g., @c stdin
+@return @c true if a line has been read, @c false at end of file
+@see for_each_line, get_line, s_input
+*/
+bool read_line(LineBuffer *b, FILE *f);
+
+/**
+Frees the memory of the line buffer. The buffer can be reused afterwards.
+@param[in,out] b line buffer
+*/
+void free_line_buffer(LineBuffer *b);
+
+/**
+Iterates over the lines of file @c f. The line buffer @c b is declared by the macro and is only valid within the loop. Its memory is freed when the loop ends, also if the loop is left with @c break.
+
+Example:
+@code{.c}
+int n = 0;
+for_each_line(b, stdin) {
+    if (s_contains(b.s, "error")) n++;
+}
+printiln(n);
+@endcode
+
+@param[in] b name of the line buffer variable
+@param[in] f file to read from
+@see read_line
+*/
+#define for_each_line(b, f) \
+for (LineBuffer b __attribute__((cleanup(free_line_buffer))) = make_line_buffer(); read_line(&b, f); )
+
 /**
 Reads an integer from standard input. The input has to be terminated by a line break.
 */
@@ -893,10 +1156,10 @@ double d_input(void);
 // Files
 
 /**
-Reads the contents of a file into a String. The function fails if the file does not exist or cannot be read.
+Reads the contents of a file into a String. The function fails if the file does not exist or cannot be read. Works for files of unknown size, such as pipes (e.g., @c "/dev/stdin") and files in @c /proc, and for files larger than 2 GB.
 @param[in] name file name (including path)
 @return newly allocated String with data read from file
-@see s_write_file, write_file_data
+@see s_write_file, read_file_data
 */
 String s_read_file(String name);
 
@@ -913,10 +1176,18 @@ Writes a memory block to a file. An existing file of the same name will be overw
 @param[in] name file name (including path)
 @param[in] data the data to write to the file
 @param[in] n the number of bytes to write to the file
-@pre "non-negative length", n >= 0
-@see s_read_file, s_write_file
+@see read_file_data, s_write_file
+*/
+void write_file_data(String name, Byte *data, size_t n);
+
+/**
+Reads the contents of a file into a memory block. The data is read unchanged (in binary mode). The function fails if the file does not exist or cannot be read. Works for files of unknown size, such as pipes, and for files larger than 2 GB.
+@param[in] name file name (including path)
+@param[out] n the number of bytes read
+@return newly allocated memory block with the data read from the file, followed by a zero byte that is not counted in @c n
+@see write_file_data, s_read_file
 */
-void write_file_data(String name, Byte *data, int n);
+Byte *read_file_data(String name, size_t *n);
 
 
 
@@ -955,6 +1226,12 @@ bool b_rnd(void);
 /** A very small positive value.*/
 #define EPSILON 0.00000001
 
+/** Number of executed tests, reported when the program exits. @private */
+extern int base_check_count;
+
+/** Number of passed tests, reported when the program exits. @private */
+extern int base_check_success_count;
+
 /** Checks whether the actual value @c a is equal to the expected value @c e. */
 bool base_test_equal_b(const char *file, int line, bool a, bool e);
 
@@ -9,83 +9,21 @@
 ////////////////////////////////////////////////////////////////////////////
 // Types (and type constructors)
 
-IntOption make_int_none(void) {
-    IntOption op = { true, 0 };
-    return op;
-}
-
-IntOption make_int_some(int some) {
-    IntOption op = { false, some };
-    return op;
-}
-
-ByteOption make_byte_none(void) {
-    ByteOption op = { true, 0 };
-    return op;
-}
-
-ByteOption make_byte_some(Byte some) {
-    ByteOption op = { false, some };
-    return op;
-}
-
-DoubleOption make_double_none(void) {
-    DoubleOption op = { true, 0.0 };
-    return op;
-}
-
-DoubleOption make_double_some(double some) {
-    DoubleOption op = { false, some };
-    return op;
-}
-
-StringOption make_string_none(void) {
-    StringOption op = { true, NULL };
-    return op;
-}
-
-StringOption make_string_some(String some) {
-    StringOption op = { false, some };
-    return op;
-}
-
-IntPair make_int_pair(int i, int j) {
-    IntPair result = { i, j };
-    return result;
-}
-
-IntTriple make_int_triple(int i, int j, int k) {
-    IntTriple result = { i, j, k };
-    return result;
-}
-
-DoublePair make_double_pair(double i, double j) {
-    DoublePair result = { i, j };
-    return result;
-}
-
-DoubleTriple make_double_triple(double i, double j, double k) {
-    DoubleTriple result = { i, j, k };
-    return result;
-}
-
-AnyPair make_any_pair(Any a, Any b) {
-    AnyPair result = { a, b };
-    return result;
-}
-
-AnyTriple make_any_triple(Any a, Any b, Any c) {
-    AnyTriple result = { a, b, c };
-    return result;
-}
-
-StringPair make_string_pair(String a, String b) {
-    StringPair result = { a, b };
-    return result;
-}
-
-StringTriple make_string_triple(String a, String b, String c) {
-    StringTriple result = { a, b, c };
-    return result;
-}
-
+// external definitions of the inline constructors of basedefs.h
+extern IntOption make_int_none(void);
+extern IntOption make_int_some(int some);
+extern ByteOption make_byte_none(void);
+extern ByteOption make_byte_some(Byte some);
+extern DoubleOption make_double_none(void);
+extern DoubleOption make_double_some(double some);
+extern StringOption make_string_none(void);
+extern StringOption make_string_some(String some);
+extern IntPair make_int_pair(int i, int j);
+extern IntTriple make_int_triple(int i, int j, int k);
+extern DoublePair make_double_pair(double i, double j);
+extern DoubleTriple make_double_triple(double i, double j, double k);
+extern AnyPair make_any_pair(Any a, Any b);
+extern AnyTriple make_any_triple(Any a, Any b, Any c);
+extern StringPair make_string_pair(String a, String b);
+extern StringTriple make_string_triple(String a, String b, String c);
+extern StringView make_string_view(const char *s, int length);
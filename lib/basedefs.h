@@ -108,6 +108,15 @@ typedef struct {
     String c;
 } StringTriple;
 
+/**
+A view of a sequence of characters that is stored elsewhere, e.g., in the buffer of a file reader. The characters are not zero-terminated. The view does not own the characters, so they must not be freed through the view.
+@see make_string_view
+*/
+typedef struct {
+    const char *s;
+    int length;
+} StringView;
+
 /** 
 The possible results of comparing two comparable entities a and b: 
 - a may be less than b (LT), 
@@ -207,13 +216,19 @@ typedef struct StringOption {
 ////////////////////////////////////////////////////////////////////////////
 // Constructors
 
+// The constructors are inline, such that they cost nothing in optimized code.
+// basedefs.c has their external definitions for calls that are not inlined.
+
 /** 
 Creates a pair of integers (on the stack).
 @param[in] i first element
 @param[in] j second element
 @return the pair
 */
-IntPair make_int_pair(int i, int j);
+inline IntPair make_int_pair(int i, int j) {
+    IntPair result = { i, j };
+    return result;
+}
     
 /** 
 Creates a pair of integers (on the stack).
@@ -222,7 +237,10 @@ Creates a pair of integers (on the stack).
 @param[in] k third element
 @return the triple
 */
-IntTriple make_int_triple(int i, int j, int k);
+inline IntTriple make_int_triple(int i, int j, int k) {
+    IntTriple result = { i, j, k };
+    return result;
+}
 
 /** 
 Creates a pair of doubles (on the stack).
@@ -230,7 +248,10 @@ Creates a pair of doubles (on the stack).
 @param[in] j second element
 @return the pair
 */
-DoublePair make_double_pair(double i, double j);
+inline DoublePair make_double_pair(double i, double j) {
+    DoublePair result = { i, j };
+    return result;
+}
 
 /** 
 Creates a pair of doubles (on the stack).
@@ -239,7 +260,10 @@ Creates a pair of doubles (on the stack).
 @param[in] k third element
 @return the triple
 */
-DoubleTriple make_double_triple(double i, double j, double k);
+inline DoubleTriple make_double_triple(double i, double j, double k) {
+    DoubleTriple result = { i, j, k };
+    return result;
+}
 
 /** 
 Creates a pair of Anys (on the stack).
@@ -247,7 +271,10 @@ Creates a pair of Anys (on the stack).
 @param[in] b second element
 @return the pair
 */
-AnyPair make_any_pair(Any a, Any b);
+inline AnyPair make_any_pair(Any a, Any b) {
+    AnyPair result = { a, b };
+    return result;
+}
 
 /** 
 Creates a tuple of three Anys (on the stack).
@@ -256,7 +283,10 @@ Creates a tuple of three Anys (on the stack).
 @param[in] c third element
 @return the triple
 */
-AnyTriple make_any_triple(Any a, Any b, Any c);
+inline AnyTriple make_any_triple(Any a, Any b, Any c) {
+    AnyTriple result = { a, b, c };
+    return result;
+}
 
 /** 
 Creates a pair of Strings (on the stack).
@@ -264,7 +294,10 @@ Creates a pair of Strings (on the stack).
 @param[in] b second element
 @return the pair
 */
-StringPair make_string_pair(String a, String b);
+inline StringPair make_string_pair(String a, String b) {
+    StringPair result = { a, b };
+    return result;
+}
 
 /** 
 Creates a tuple of three Strings (on the stack).
@@ -273,59 +306,97 @@ Creates a tuple of three Strings (on the stack).
 @param[in] c third element
 @return the triple
 */
-StringTriple make_string_triple(String a, String b, String c);
+inline StringTriple make_string_triple(String a, String b, String c) {
+    StringTriple result = { a, b, c };
+    return result;
+}
+
+/** 
+Creates a view of @c length characters starting at @c s (on the stack).
+@param[in] s first character
+@param[in] length number of characters
+@return the view
+*/
+inline StringView make_string_view(const char *s, int length) {
+    StringView result = { s, length };
+    return result;
+}
 
 /**
 Creates a non-present integer option (on the stack).
 @return the option value
 */
-IntOption make_int_none(void);
+inline IntOption make_int_none(void) {
+    IntOption op = { true, 0 };
+    return op;
+}
 
 /**
 Creates an integer option for some value (on the stack).
 @param[in] some some value
 @return the option value
 */
-IntOption make_int_some(int some);
+inline IntOption make_int_some(int some) {
+    IntOption op = { false, some };
+    return op;
+}
 
 /**
 Creates a non-present byte option (on the stack).
 @return the option value
 */
-ByteOption make_byte_none(void);
+inline ByteOption make_byte_none(void) {
+    ByteOption op = { true, 0 };
+    return op;
+}
 
 /**
 Creates a byte option for some value (on the stack).
 @param[in] some some value
 @return the option value
 */
-ByteOption make_byte_some(Byte some);
+inline ByteOption make_byte_some(Byte some) {
+    ByteOption op = { false, some };
+    return op;
+}
 
 /**
 Creates a non-present double option (on the stack).
 @return the option value
 */
-DoubleOption make_double_none(void);
+inline DoubleOption make_double_none(void) {
+    DoubleOption op = { true, 0.0 };
+    return op;
+}
 
 /**
 Creates a double option for some value (on the stack).
 @param[in] some some value
 @return the option value
 */
-DoubleOption make_double_some(double some);
+inline DoubleOption make_double_some(double some) {
+    DoubleOption op = { false, some };
+    return op;
+}
 
 /**
 Creates a non-present String option (on the stack).
 @return the option value
 */
-StringOption make_string_none(void);
+inline StringOption make_string_none(void) {
+    StringOption op = { true, NULL };
+    return op;
+}
 
 /**
 Creates a String option for some value (on the stack).
 @param[in] some some value
 @return the option value
 */
-StringOption make_string_some(String some);
+inline StringOption make_string_some(String some) {
+    StringOption op = { false, some };
+    return op;
+}
 
 #endif
 
@@ -0,0 +1,347 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include "bench.h"
+#include "parse.h"
+
+////////////////////////////////////////////////////////////////////////////
+// Registry
+
+typedef struct Benchmark {
+    String name;
+    BenchFunction f;
+} Benchmark;
+
+static Benchmark *benchmarks = NULL;
+static int n_benchmarks = 0;
+static int benchmarks_capacity = 0;
+
+void bench_register(String name, BenchFunction f) {
+    require_not_null(name);
+    require_not_null(f);
+    if (n_benchmarks == benchmarks_capacity) {
+        benchmarks_capacity = (benchmarks_capacity == 0) ? 16 : 2 * benchmarks_capacity;
+        benchmarks = xrealloc(benchmarks, benchmarks_capacity * sizeof(Benchmark));
+    }
+    benchmarks[n_benchmarks].name = name;
+    benchmarks[n_benchmarks].f = f;
+    n_benchmarks++;
+}
+
+static void clear_registry(void) {
+    free(benchmarks);
+    benchmarks = NULL;
+    n_benchmarks = benchmarks_capacity = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Running
+
+BenchOptions make_bench_options(void) {
+    BenchOptions o = { NULL, BENCH_TEXT, NULL, 20, 10, 100, NULL };
+    return o;
+}
+
+static int64_t time_iterations(BenchFunction f, int64_t iterations) {
+    int64_t start = time_ns();
+    f(iterations);
+    return time_ns_since(start);
+}
+
+// Upper bound of the number of iterations of a run.
+#define BENCH_MAX_ITERATIONS 1000000000000LL
+
+// Chooses the number of iterations such that a run takes at least min_run_ns.
+// The runs while searching serve as the warm-up. Gives up if the time does not
+// grow with the iterations, e.g., because the compiler removed the measured code.
+static int64_t choose_iterations(String name, BenchFunction f, int64_t min_run_ns, int64_t warm_up_ns) {
+    int64_t iterations = 1;
+    int64_t total = 0;
+    int64_t previous = 0; // the time of the run with a tenth of the iterations
+    for (;;) {
+        int64_t t = time_iterations(f, iterations);
+        total += t;
+        if (t >= min_run_ns) {
+            if (total >= warm_up_ns) return iterations;
+        } else if ((previous > 0 && iterations >= 1000000 && t < 2 * previous)
+                || iterations >= BENCH_MAX_ITERATIONS / 10) {
+            fprintf(stderr, "%s: the time does not grow with the iterations, was the measured code "
+                    "removed? (see bench_do_not_optimize)\n", name);
+            return iterations;
+        } else if (t < min_run_ns / 10) {
+            previous = t;
+            iterations *= 10;
+        } else {
+            // aim a little higher than needed, the estimate is noisy
+            previous = 0;
+            iterations = (int64_t)(1.2 * iterations * min_run_ns / t) + 1;
+            if (iterations > BENCH_MAX_ITERATIONS) iterations = BENCH_MAX_ITERATIONS;
+        }
+    }
+}
+
+static int compare_doubles(ConstAny a, ConstAny b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Interpolates between the two nearest samples of the sorted array.
+static double percentile(const double *sorted, int n, double p) {
+    double position = p * (n - 1);
+    int i = (int)position;
+    if (i >= n - 1) return sorted[n - 1];
+    double fraction = position - i;
+    return sorted[i] + fraction * (sorted[i + 1] - sorted[i]);
+}
+
+BenchResult bench_run(String name, BenchFunction f, const BenchOptions *options) {
+    require_not_null(name);
+    require_not_null(f);
+    require_not_null(options);
+    require("positive number of runs", options->repeats > 0);
+    int64_t iterations = choose_iterations(name, f, (int64_t)(1e6 * options->min_run_ms), (int64_t)(1e6 * options->warm_up_ms));
+    int n = options->repeats;
+    double *ns = xmalloc(n * sizeof(double));
+    double sum = 0;
+    int64_t counts[PERF_EVENTS] = { 0 };
+    int available = perf_available() ? -1 : 0;
+    for (int i = 0; i < n; i++) {
+        PerfCounts start = perf_now();
+        ns[i] = (double)time_iterations(f, iterations) / iterations;
+        PerfCounts c = perf_since(start);
+        sum += ns[i];
+        available &= c.available;
+        for (PerfEvent e = 0; e < PERF_EVENTS; e++) counts[e] += c.values[e];
+    }
+    double mean = sum / n;
+    double squares = 0;
+    for (int i = 0; i < n; i++) squares += (ns[i] - mean) * (ns[i] - mean);
+    qsort(ns, n, sizeof(double), compare_doubles);
+    BenchResult r;
+    r.name = name;
+    r.iterations = iterations;
+    r.runs = n;
+    r.min_ns = ns[0];
+    r.median_ns = percentile(ns, n, 0.5);
+    r.mean_ns = mean;
+    r.stddev_ns = (n > 1) ? sqrt(squares / (n - 1)) : 0;
+    r.p99_ns = percentile(ns, n, 0.99);
+    r.max_ns = ns[n - 1];
+    r.baseline_ns = 0;
+    r.counters_available = available;
+    for (PerfEvent e = 0; e < PERF_EVENTS; e++) {
+        r.counters[e] = (available & (1 << e)) ? (double)counts[e] / ((double)n * iterations) : 0;
+    }
+    free(ns);
+    return r;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Output
+
+static void print_json_string(FILE *f, String s) {
+    fputc('"', f);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static bool has_counter(const BenchResult *r, PerfEvent e) {
+    return (r->counters_available & (1 << e)) != 0;
+}
+
+// Prints the counters per iteration as columns, or dashes for unavailable ones.
+static void print_text_counters(FILE *f, const BenchResult *r) {
+    for (PerfEvent e = 0; e < PERF_EVENTS; e++) {
+        if (has_counter(r, e)) fprintf(f, " %12.2f", r->counters[e]);
+        else fprintf(f, " %12s", "-");
+        if (e == PERF_INSTRUCTIONS) {
+            if (has_counter(r, PERF_CYCLES) && has_counter(r, PERF_INSTRUCTIONS) && r->counters[PERF_CYCLES] > 0) {
+                fprintf(f, " %5.2f", r->counters[PERF_INSTRUCTIONS] / r->counters[PERF_CYCLES]);
+            } else {
+                fprintf(f, " %5s", "-");
+            }
+        }
+    }
+}
+
+void bench_print(FILE *f, const BenchResult *results, int n, BenchFormat format) {
+    require_not_null(f);
+    require("results not null", results != NULL || n == 0);
+    bool counters = false;
+    for (int i = 0; i < n; i++) counters |= results[i].counters_available != 0;
+    switch (format) {
+        case BENCH_TEXT:
+            fprintf(f, "%-32s %12s %5s %12s %12s %10s %12s %9s",
+                    "benchmark", "iterations", "runs", "median ns", "mean ns", "stddev", "p99 ns", "baseline");
+            if (counters) {
+                fprintf(f, " %12s %12s %5s %12s %12s %12s",
+                        "cycles", "instructions", "IPC", "branch miss", "L1d miss", "LLC miss");
+            }
+            fprintf(f, "\n");
+            for (int i = 0; i < n; i++) {
+                const BenchResult *r = results + i;
+                fprintf(f, "%-32s %12lld %5d %12.2f %12.2f %10.2f %12.2f",
+                        r->name, (long long)r->iterations, r->runs, r->median_ns, r->mean_ns, r->stddev_ns, r->p99_ns);
+                if (r->baseline_ns > 0) fprintf(f, " %9.2f", r->median_ns / r->baseline_ns);
+                else fprintf(f, " %9s", "-");
+                if (counters) print_text_counters(f, r);
+                fprintf(f, "\n");
+            }
+            if (counters) fprintf(f, "(counters are per iteration)\n");
+            break;
+        case BENCH_JSON:
+            fprintf(f, "{\n  \"benchmarks\": [");
+            for (int i = 0; i < n; i++) {
+                const BenchResult *r = results + i;
+                fprintf(f, "%s\n    {\"name\": ", (i > 0) ? "," : "");
+                print_json_string(f, r->name);
+                fprintf(f, ", \"iterations\": %lld, \"runs\": %d, \"min_ns\": %.3f, \"median_ns\": %.3f, "
+                        "\"mean_ns\": %.3f, \"stddev_ns\": %.3f, \"p99_ns\": %.3f, \"max_ns\": %.3f",
+                        (long long)r->iterations, r->runs, r->min_ns, r->median_ns,
+                        r->mean_ns, r->stddev_ns, r->p99_ns, r->max_ns);
+                for (PerfEvent e = 0; e < PERF_EVENTS; e++) {
+                    if (has_counter(r, e)) fprintf(f, ", \"%s\": %.3f", perf_event_name(e), r->counters[e]);
+                }
+                fprintf(f, "}");
+            }
+            fprintf(f, "\n  ]\n}\n");
+            break;
+        case BENCH_CSV:
+            fprintf(f, "name,iterations,runs,min_ns,median_ns,mean_ns,stddev_ns,p99_ns,max_ns");
+            for (PerfEvent e = 0; e < PERF_EVENTS; e++) fprintf(f, ",%s", perf_event_name(e));
+            fprintf(f, "\n");
+            for (int i = 0; i < n; i++) {
+                const BenchResult *r = results + i;
+                fprintf(f, "%s,%lld,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f",
+                        r->name, (long long)r->iterations, r->runs, r->min_ns, r->median_ns,
+                        r->mean_ns, r->stddev_ns, r->p99_ns, r->max_ns);
+                for (PerfEvent e = 0; e < PERF_EVENTS; e++) {
+                    if (has_counter(r, e)) fprintf(f, ",%.3f", r->counters[e]);
+                    else fprintf(f, ",");
+                }
+                fprintf(f, "\n");
+            }
+            break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Baseline
+
+// Finds the median time of the named benchmark in JSON output of bench_print.
+// Returns 0 if the benchmark is not in the baseline.
+static double baseline_median(String json, String name) {
+    int n = strlen(name);
+    for (String s = strstr(json, "\"name\": \""); s != NULL; s = strstr(s + 1, "\"name\": \"")) {
+        s += strlen("\"name\": \"");
+        if (strncmp(s, name, n) != 0 || s[n] != '"') continue;
+        String median = strstr(s, "\"median_ns\": ");
+        String end = strchr(s, '}');
+        if (median == NULL || (end != NULL && median > end)) return 0;
+        return strtod(median + strlen("\"median_ns\": "), NULL);
+    }
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Command line
+
+static void print_usage(String program) {
+    fprintf(stderr, "usage: %s [options]\n"
+            "  --filter=text            run only benchmarks whose name contains text\n"
+            "  --format=text|json|csv   format of the results (default: text)\n"
+            "  --output=file            write the results to file (default: stdout)\n"
+            "  --repeats=n              number of timed runs (default: 20)\n"
+            "  --min-run-ms=ms          minimum duration of a timed run (default: 10)\n"
+            "  --warm-up-ms=ms          minimum warm-up time (default: 100)\n"
+            "  --baseline=file          compare with the JSON results in file\n"
+            "  --list                   list the benchmarks without running them\n"
+            "  --help                   print this message\n", program);
+}
+
+// Gets the value of an option of the form --name=value, or NULL if arg is another option.
+static String option_value(String arg, String name) {
+    int n = strlen(name);
+    if (strncmp(arg, name, n) == 0 && arg[n] == '=') return arg + n + 1;
+    return NULL;
+}
+
+static void invalid_option(String program, String arg) {
+    fprintf(stderr, "%s: invalid option %s\n", program, arg);
+    print_usage(program);
+    base_exit(EXIT_FAILURE);
+}
+
+int bench_main(int argc, String argv[]) {
+    require("program name", argc >= 1);
+    String program = argv[0];
+    BenchOptions options = make_bench_options();
+    bool list = false;
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        String value;
+        if (strcmp(arg, "--help") == 0) {
+            print_usage(program);
+            clear_registry();
+            return EXIT_SUCCESS;
+        } else if (strcmp(arg, "--list") == 0) {
+            list = true;
+        } else if ((value = option_value(arg, "--filter")) != NULL) {
+            options.filter = value;
+        } else if ((value = option_value(arg, "--baseline")) != NULL) {
+            options.baseline = value;
+        } else if ((value = option_value(arg, "--output")) != NULL) {
+            options.output = value;
+        } else if ((value = option_value(arg, "--format")) != NULL) {
+            if (strcmp(value, "text") == 0) options.format = BENCH_TEXT;
+            else if (strcmp(value, "json") == 0) options.format = BENCH_JSON;
+            else if (strcmp(value, "csv") == 0) options.format = BENCH_CSV;
+            else invalid_option(program, arg);
+        } else if ((value = option_value(arg, "--repeats")) != NULL) {
+            if (!parse_int(value, strlen(value), &options.repeats) || options.repeats <= 0) invalid_option(program, arg);
+        } else if ((value = option_value(arg, "--min-run-ms")) != NULL) {
+            if (!parse_double(value, strlen(value), &options.min_run_ms) || options.min_run_ms < 0) invalid_option(program, arg);
+        } else if ((value = option_value(arg, "--warm-up-ms")) != NULL) {
+            if (!parse_double(value, strlen(value), &options.warm_up_ms) || options.warm_up_ms < 0) invalid_option(program, arg);
+        } else {
+            invalid_option(program, arg);
+        }
+    }
+
+    String baseline = (options.baseline != NULL && !list) ? s_read_file(options.baseline) : NULL;
+    BenchResult *results = xmalloc((n_benchmarks + 1) * sizeof(BenchResult));
+    int n = 0;
+    for (int i = 0; i < n_benchmarks; i++) {
+        Benchmark *b = benchmarks + i;
+        if (options.filter != NULL && strstr(b->name, options.filter) == NULL) continue;
+        if (list) {
+            printsln(b->name);
+        } else {
+            results[n] = bench_run(b->name, b->f, &options);
+            if (baseline != NULL) results[n].baseline_ns = baseline_median(baseline, b->name);
+            n++;
+        }
+    }
+    if (!list) {
+        FILE *f = stdout;
+        if (options.output != NULL) {
+            f = fopen(options.output, "w");
+            if (f == NULL) {
+                fprintf(stderr, "%s: Cannot open %s\n", program, options.output);
+                base_exit(EXIT_FAILURE);
+            }
+        }
+        bench_print(f, results, n, options.format);
+        if (f != stdout) fclose(f);
+    }
+    if (baseline != NULL) free(baseline);
+    free(results);
+    clear_registry();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+/** @file
+Microbenchmarks with statistics. A benchmark is a function that runs the code to measure a given number of times. The harness chooses the number of iterations such that one run takes long enough to be timed precisely, warms up caches and branch predictors, repeats the run several times, and reports the median, mean, standard deviation, and 99th percentile of the time per iteration. Results are printed as a table, or as JSON or CSV to track regressions. If hardware performance counters are available (see perfcount.h), the reports also show cycles, instructions, branch misses, and cache misses per iteration.
+
+Example: Compare copying a String to dynamic memory and to a local array.
+@code{.c}
+#include "base.h"
+#include "bench.h"
+
+BENCHMARK(s_copy) {
+    for (int64_t i = 0; i < iterations; i++) {
+        String s = s_copy("hello world");
+        bench_do_not_optimize(s);
+        free(s);
+    }
+}
+
+BENCHMARK(memcpy) {
+    char s[16];
+    for (int64_t i = 0; i < iterations; i++) {
+        memcpy(s, "hello world", 12);
+        bench_do_not_optimize(s);
+    }
+}
+
+BENCHMARK_MAIN()
+@endcode
+
+Run the program with @c --help to see the options, e.g., @c --format=json or @c --filter=copy. To judge a change, save the results before the change with @c --format=json @c --output=baseline.json and run the benchmarks after the change with @c --baseline=baseline.json.
+
+The result of the measured code should be passed to @ref bench_do_not_optimize. Otherwise the compiler may remove the computation, since the result is not used. If the time of a run does not grow with the number of iterations, the harness warns about this and reports the benchmark as is.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include "base.h"
+#include "perfcount.h"
+
+/**
+Runs the code to measure the given number of times.
+@param[in] iterations how often to run the code
+*/
+typedef void (*BenchFunction)(int64_t iterations);
+
+/**
+Defines and registers a benchmark. The body follows the macro and runs the code to measure @c iterations times. Registered benchmarks are run by @ref bench_main in the order of their definition.
+@param[in] name the name of the benchmark, must be a valid identifier
+*/
+#define BENCHMARK(name) \
+    static void bench_##name(int64_t iterations);\
+    __attribute__((constructor)) static void bench_register_##name(void) {\
+        bench_register(#name, bench_##name);\
+    }\
+    static void bench_##name(int64_t iterations)
+
+/**
+Defines a main function that runs all registered benchmarks.
+*/
+#define BENCHMARK_MAIN() \
+    int main(int argc, String argv[]) {\
+        return bench_main(argc, argv);\
+    }
+
+/**
+Prevents the compiler from removing the computation of a value. The value is treated as if it was read by code the compiler cannot see. Costs no instructions, except possibly a store to memory.
+@param[in] value the value to keep
+*/
+#define bench_do_not_optimize(value) __asm__ volatile("" : : "g"(value) : "memory")
+
+/**
+Prevents the compiler from removing or reordering stores to memory across this point, as if all memory was read and written here.
+*/
+#define bench_clobber() __asm__ volatile("" : : : "memory")
+
+/**
+Output formats of benchmark results.
+*/
+typedef enum BenchFormat {
+    BENCH_TEXT, ///< a table for humans
+    BENCH_JSON, ///< a JSON object with an array of results
+    BENCH_CSV ///< a header line followed by one line per result
+} BenchFormat;
+
+/**
+Controls how benchmarks are run.
+@see make_bench_options
+*/
+typedef struct BenchOptions {
+    String filter; ///< run only benchmarks whose name contains this String, or NULL for all
+    BenchFormat format; ///< format of the results
+    String output; ///< file to write the results to, or NULL for stdout
+    int repeats; ///< number of timed runs
+    double min_run_ms; ///< minimum duration of a run, determines the number of iterations
+    double warm_up_ms; ///< minimum untimed running time before the timed runs
+    String baseline; ///< JSON results of an earlier run to compare with, or NULL
+} BenchOptions;
+
+/**
+The statistics of the timed runs of a benchmark. Times are per iteration.
+*/
+typedef struct BenchResult {
+    String name; ///< the name of the benchmark
+    int64_t iterations; ///< number of iterations per run
+    int runs; ///< number of timed runs
+    double min_ns; ///< shortest time
+    double median_ns; ///< median time
+    double mean_ns; ///< mean time
+    double stddev_ns; ///< standard deviation of the time
+    double p99_ns; ///< 99th percentile of the time
+    double max_ns; ///< longest time
+    double baseline_ns; ///< median time in the baseline, or 0 if there is none
+    double counters[PERF_EVENTS]; ///< mean counts of the performance counters per iteration, indexed by PerfEvent
+    int counters_available; ///< bit e is set if counters[e] is valid
+} BenchResult;
+
+/**
+Creates the default options: all benchmarks, text format, 20 runs of at least 10 ms each, after at least 100 ms of warm-up.
+@return the default options
+*/
+BenchOptions make_bench_options(void);
+
+/**
+Registers a benchmark to be run by @ref bench_main. Usually called by @ref BENCHMARK.
+@param[in] name the name of the benchmark (not copied)
+@param[in] f the benchmark function
+*/
+void bench_register(String name, BenchFunction f);
+
+/**
+Runs a benchmark. First runs it with increasing numbers of iterations until a run takes at least @c min_run_ms milliseconds and the total time is at least @c warm_up_ms milliseconds. Then times @c repeats runs with this number of iterations, and counts their events with the performance counters, if available.
+@param[in] name the name of the benchmark
+@param[in] f the benchmark function
+@param[in] options how to run the benchmark
+@return the statistics of the timed runs
+*/
+BenchResult bench_run(String name, BenchFunction f, const BenchOptions *options);
+
+/**
+Prints benchmark results in the given format. In text format, results with a baseline show the ratio of the median time to the baseline, e.g., 1.25 if the benchmark is 25% slower than in the baseline. Performance counters are shown per iteration, if available.
+@param[in] f the stream to print to, e.g., @c stdout
+@param[in] results the results
+@param[in] n number of results
+@param[in] format the format
+*/
+void bench_print(FILE *f, const BenchResult *results, int n, BenchFormat format);
+
+/**
+Runs the registered benchmarks and prints their results. Understands the command line options @c --filter=text, @c --format=text|json|csv, @c --output=file, @c --repeats=n, @c --min-run-ms=ms, @c --warm-up-ms=ms, @c --baseline=file, @c --list, and @c --help. The baseline file is the JSON output of an earlier run. Exits the program with a usage message on unknown options.
+@param[in] argc number of command line arguments
+@param[in] argv command line arguments
+@return the exit status of the program
+*/
+int bench_main(int argc, String argv[]);
+
+#endif
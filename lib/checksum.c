@@ -0,0 +1,273 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __x86_64__
+#include <nmmintrin.h>
+#endif
+#include "checksum.h"
+#include "parallel.h"
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NATIVE_LITTLE_ENDIAN 1
+#else
+#define NATIVE_LITTLE_ENDIAN 0
+#endif
+
+// Loads 8 bytes in little endian order.
+static inline uint64_t load_64(const Byte *p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return NATIVE_LITTLE_ENDIAN ? w : __builtin_bswap64(w);
+}
+
+// Reads a file in large blocks and passes each block to the consumer.
+static void read_blocks(String function, String name, void (*consume)(const Byte *data, size_t n, Any state), Any state) {
+    require_not_null(name);
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: Cannot open %s\n", function, name);
+        base_exit(EXIT_FAILURE);
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    int capacity = 1024 * 1024;
+    Byte *buffer = xmalloc(capacity);
+    for (;;) {
+        ssize_t k = read(fd, buffer, capacity);
+        if (k == 0) break;
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "%s: Cannot read %s\n", function, name);
+            base_exit(EXIT_FAILURE);
+        }
+        base_metric_add(BASE_METRIC_BYTES_READ, k);
+        consume(buffer, k, state);
+    }
+    free(buffer);
+    close(fd);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CRC32C
+
+// The Castagnoli polynomial, bit-reversed.
+#define CRC32C_POLY 0x82f63b78u
+
+// crc_tables[k][b] is the CRC of byte b followed by k zero bytes, for
+// processing 8 bytes per step ("slicing by 8").
+static uint32_t crc_tables[8][256];
+static pthread_once_t crc_tables_once = PTHREAD_ONCE_INIT;
+
+static void make_crc_tables(void) {
+    for (int b = 0; b < 256; b++) {
+        uint32_t crc = b;
+        for (int i = 0; i < 8; i++) crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+        crc_tables[0][b] = crc;
+    }
+    for (int b = 0; b < 256; b++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t crc = crc_tables[k - 1][b];
+            crc_tables[k][b] = (crc >> 8) ^ crc_tables[0][crc & 0xff];
+        }
+    }
+}
+
+uint32_t crc32c_update_table(uint32_t crc, const Byte *data, size_t n) {
+    require("data not null", data != NULL || n == 0);
+    pthread_once(&crc_tables_once, make_crc_tables);
+    crc = ~crc;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w = load_64(data + i) ^ crc;
+        crc = crc_tables[7][w & 0xff] ^ crc_tables[6][(w >> 8) & 0xff]
+            ^ crc_tables[5][(w >> 16) & 0xff] ^ crc_tables[4][(w >> 24) & 0xff]
+            ^ crc_tables[3][(w >> 32) & 0xff] ^ crc_tables[2][(w >> 40) & 0xff]
+            ^ crc_tables[1][(w >> 48) & 0xff] ^ crc_tables[0][w >> 56];
+    }
+    for (; i < n; i++) crc = (crc >> 8) ^ crc_tables[0][(crc ^ data[i]) & 0xff];
+    return ~crc;
+}
+
+#ifdef __x86_64__
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_update_sse42(uint32_t crc, const Byte *data, size_t n) {
+    uint64_t c = ~crc;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) c = _mm_crc32_u64(c, load_64(data + i));
+    for (; i < n; i++) c = _mm_crc32_u8(c, data[i]);
+    return ~(uint32_t)c;
+}
+#endif
+
+uint32_t crc32c_update(uint32_t crc, const Byte *data, size_t n) {
+    require("data not null", data != NULL || n == 0);
+#ifdef __x86_64__
+    static int has_sse42 = -1;
+    if (has_sse42 < 0) has_sse42 = __builtin_cpu_supports("sse4.2");
+    if (has_sse42) return crc32c_update_sse42(crc, data, n);
+#endif
+    return crc32c_update_table(crc, data, n);
+}
+
+uint32_t crc32c(const Byte *data, size_t n) {
+    return crc32c_update(0, data, n);
+}
+
+// Multiplies two polynomials modulo the CRC polynomial (bit-reversed representation).
+static uint32_t multiply_mod_poly(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = 1u << 31; m != 0; m >>= 1) {
+        if (a & m) product ^= b;
+        b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return product;
+}
+
+// Computes x^(8n) modulo the CRC polynomial by repeated squaring.
+static uint32_t x_to_8n_mod_poly(size_t n) {
+    uint32_t result = 1u << 31; // x^0
+    uint32_t square = 1u << 23; // x^8
+    while (n > 0) {
+        if (n & 1) result = multiply_mod_poly(square, result);
+        square = multiply_mod_poly(square, square);
+        n >>= 1;
+    }
+    return result;
+}
+
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, size_t n2) {
+    // appending n2 bytes multiplies the CRC of the first part by x^(8 n2)
+    return multiply_mod_poly(x_to_8n_mod_poly(n2), crc1) ^ crc2;
+}
+
+static void consume_crc32c(const Byte *data, size_t n, Any state) {
+    uint32_t *crc = state;
+    *crc = crc32c_update(*crc, data, n);
+}
+
+uint32_t crc32c_file(String name) {
+    uint32_t crc = 0;
+    read_blocks("crc32c_file", name, consume_crc32c, &crc);
+    return crc;
+}
+
+typedef struct ChunkCrc {
+    uint32_t crc;
+    size_t size;
+} ChunkCrc;
+
+static void crc_chunk(Chunk chunk, Any result, Any context) {
+    ChunkCrc *c = result;
+    c->crc = crc32c(chunk.data, chunk.size);
+    c->size = chunk.size;
+}
+
+static void combine_crc(Any result, ConstAny partial, Any context) {
+    ChunkCrc *c = result;
+    const ChunkCrc *p = partial;
+    c->crc = crc32c_combine(c->crc, p->crc, p->size);
+    c->size += p->size;
+}
+
+uint32_t crc32c_parallel(const Byte *data, size_t n, int n_threads) {
+    require("data not null", data != NULL || n == 0);
+    require("non-negative number of threads", n_threads >= 0);
+    ChunkCrc c = { 0, 0 };
+    map_reduce_buffer(data, n, n_threads, sizeof(ChunkCrc), crc_chunk, combine_crc, &c, NULL);
+    return c.crc;
+}
+
+uint32_t crc32c_file_parallel(String name, int n_threads) {
+    require_not_null(name);
+    require("non-negative number of threads", n_threads >= 0);
+    ChunkCrc c = { 0, 0 };
+    map_reduce_file(name, n_threads, sizeof(ChunkCrc), crc_chunk, combine_crc, &c, NULL);
+    return c.crc;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 64-bit checksum
+
+#define PRIME_1 0x9e3779b185ebca87ULL
+#define PRIME_2 0xc2b2ae3d27d4eb4fULL
+
+static inline uint64_t rotate_left(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t mix(uint64_t h, uint64_t w) {
+    return rotate_left(h + w * PRIME_2, 31) * PRIME_1;
+}
+
+// Mixes stripes of 32 bytes into the lanes. The lanes are independent, such
+// that their multiplications overlap. Returns the number of bytes consumed.
+static size_t mix_stripes(uint64_t lanes[4], const Byte *p, size_t n) {
+    uint64_t h0 = lanes[0], h1 = lanes[1], h2 = lanes[2], h3 = lanes[3];
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        h0 = mix(h0, load_64(p + i));
+        h1 = mix(h1, load_64(p + i + 8));
+        h2 = mix(h2, load_64(p + i + 16));
+        h3 = mix(h3, load_64(p + i + 24));
+    }
+    lanes[0] = h0;
+    lanes[1] = h1;
+    lanes[2] = h2;
+    lanes[3] = h3;
+    return i;
+}
+
+Checksum64 make_checksum64(void) {
+    Checksum64 c = { { PRIME_1, PRIME_2, ~PRIME_1, ~PRIME_2 }, { 0 }, 0, 0 };
+    return c;
+}
+
+void checksum64_update(Checksum64 *c, const Byte *data, size_t n) {
+    require_not_null(c);
+    require("data not null", data != NULL || n == 0);
+    c->length += n;
+    if (c->n_pending > 0) {
+        size_t k = 32 - c->n_pending;
+        if (k > n) k = n;
+        memcpy(c->pending + c->n_pending, data, k);
+        c->n_pending += k;
+        data += k;
+        n -= k;
+        if (c->n_pending < 32) return;
+        mix_stripes(c->lanes, c->pending, 32);
+        c->n_pending = 0;
+    }
+    size_t k = mix_stripes(c->lanes, data, n);
+    memcpy(c->pending, data + k, n - k);
+    c->n_pending = n - k;
+}
+
+uint64_t checksum64_final(const Checksum64 *c) {
+    require_not_null(c);
+    uint64_t result = c->length;
+    for (int k = 0; k < 4; k++) result = mix(result, c->lanes[k]);
+    for (int i = 0; i < c->n_pending; i++) result = mix(result, c->pending[i]);
+    return result;
+}
+
+uint64_t checksum64(const Byte *data, size_t n) {
+    Checksum64 c = make_checksum64();
+    checksum64_update(&c, data, n);
+    return checksum64_final(&c);
+}
+
+static void consume_checksum64(const Byte *data, size_t n, Any state) {
+    checksum64_update(state, data, n);
+}
+
+uint64_t checksum64_file(String name) {
+    Checksum64 c = make_checksum64();
+    read_blocks("checksum64_file", name, consume_checksum64, &c);
+    return checksum64_final(&c);
+}
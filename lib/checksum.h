@@ -0,0 +1,145 @@
+/** @file
+Checksums for detecting corrupt data in buffers and files. CRC32C is the CRC with the Castagnoli polynomial, as used by iSCSI, ext4, and many storage formats. It is computed with the @c crc32 instruction of SSE 4.2 if the processor has it, otherwise with tables. The 64-bit checksum is faster still, but it is not a standard, and unlike a CRC it does not guarantee to detect short bursts of flipped bits.
+
+Example: Check a file against a previously computed checksum.
+@code{.c}
+uint32_t expected = 0x12345678;
+if (crc32c_file("data.bin") != expected) {
+    printsln("data.bin is corrupt");
+}
+@endcode
+
+Example: Compute a checksum of data that arrives in pieces.
+@code{.c}
+uint32_t crc = 0;
+crc = crc32c_update(crc, (Byte*)"hello ", 6);
+crc = crc32c_update(crc, (Byte*)"world", 5);
+// crc == crc32c((Byte*)"hello world", 11)
+@endcode
+
+The CRC32C values of two consecutive parts can be combined into the value of the whole with @ref crc32c_combine, so parts can be checked on different threads.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __CHECKSUM_H__
+#define __CHECKSUM_H__
+
+#include <stdint.h>
+#include "base.h"
+
+////////////////////////////////////////////////////////////////////////////
+// CRC32C
+
+/**
+Continues a CRC32C computation with the next bytes.
+@param[in] crc the CRC32C of the preceding bytes, 0 for the first bytes
+@param[in] data the next bytes
+@param[in] n number of bytes
+@return the CRC32C of the preceding and the next bytes
+*/
+uint32_t crc32c_update(uint32_t crc, const Byte *data, size_t n);
+
+/**
+Like @ref crc32c_update, but always uses tables rather than the @c crc32 instruction.
+@param[in] crc the CRC32C of the preceding bytes, 0 for the first bytes
+@param[in] data the next bytes
+@param[in] n number of bytes
+@return the CRC32C of the preceding and the next bytes
+*/
+uint32_t crc32c_update_table(uint32_t crc, const Byte *data, size_t n);
+
+/**
+Computes the CRC32C of a buffer.
+@param[in] data the bytes
+@param[in] n number of bytes
+@return the CRC32C
+*/
+uint32_t crc32c(const Byte *data, size_t n);
+
+/**
+Combines the CRC32C values of two consecutive parts into the CRC32C of both parts. Takes time logarithmic in @c n2.
+@param[in] crc1 the CRC32C of the first part
+@param[in] crc2 the CRC32C of the second part
+@param[in] n2 number of bytes of the second part
+@return the CRC32C of the first part followed by the second part
+*/
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, size_t n2);
+
+/**
+Computes the CRC32C of the contents of a file. Exits the program if the file cannot be read.
+@param[in] name file name (including path)
+@return the CRC32C
+*/
+uint32_t crc32c_file(String name);
+
+/**
+Computes the CRC32C of a buffer on several threads. Each thread computes the CRC32C of some chunks of the buffer, which are then combined.
+@param[in] data the bytes
+@param[in] n number of bytes
+@param[in] n_threads number of threads, or 0 for the number of processors
+@return the CRC32C
+*/
+uint32_t crc32c_parallel(const Byte *data, size_t n, int n_threads);
+
+/**
+Computes the CRC32C of the contents of a file on several threads. Each thread computes the CRC32C of some chunks of the file, which are then combined. Exits the program if the file cannot be read.
+@param[in] name file name (including path)
+@param[in] n_threads number of threads, or 0 for the number of processors
+@return the CRC32C
+*/
+uint32_t crc32c_file_parallel(String name, int n_threads);
+
+////////////////////////////////////////////////////////////////////////////
+// 64-bit checksum
+
+/**
+The state of a 64-bit checksum computation over several pieces of data.
+@see make_checksum64, checksum64_update, checksum64_final
+*/
+typedef struct Checksum64 {
+    uint64_t lanes[4]; ///< the state of the four lanes
+    Byte pending[32]; ///< bytes that do not yet fill a stripe of 32 bytes
+    int n_pending; ///< number of bytes in pending
+    size_t length; ///< total number of bytes so far
+} Checksum64;
+
+/**
+Starts a 64-bit checksum computation.
+@return the initial state
+*/
+Checksum64 make_checksum64(void);
+
+/**
+Continues a 64-bit checksum computation with the next bytes.
+@param[in,out] c the state
+@param[in] data the next bytes
+@param[in] n number of bytes
+*/
+void checksum64_update(Checksum64 *c, const Byte *data, size_t n);
+
+/**
+Gets the 64-bit checksum of all bytes so far. The state is not changed.
+@param[in] c the state
+@return the checksum
+*/
+uint64_t checksum64_final(const Checksum64 *c);
+
+/**
+Computes the 64-bit checksum of a buffer. The checksum mixes 8-byte words into four independent lanes with multiplications and rotations. The result does not depend on the byte order of the machine.
+@param[in] data the bytes
+@param[in] n number of bytes
+@return the checksum
+*/
+uint64_t checksum64(const Byte *data, size_t n);
+
+/**
+Computes the 64-bit checksum of the contents of a file. Exits the program if the file cannot be read.
+@param[in] name file name (including path)
+@return the checksum
+*/
+uint64_t checksum64_file(String name);
+
+#endif
@@ -0,0 +1,408 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "compress.h"
+#include "stream.h"
+
+////////////////////////////////////////////////////////////////////////////
+// Codec
+
+// A compressed buffer is a sequence of sequences. Each sequence consists of
+// - a token byte: number of literals (high 4 bits), match length - 4 (low 4 bits),
+// - more bytes of the number of literals if it is 15 or more, each adding up to 255,
+// - the literals,
+// - the offset of the match (2 bytes, little endian),
+// - more bytes of the match length if it is 19 or more, each adding up to 255.
+// The last sequence only has literals and ends the buffer.
+
+#define HASH_BITS 14
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+// The last bytes are always literals, such that matches can be compared word by word.
+#define LAST_LITERALS 8
+
+static inline uint32_t read_32(const Byte *p) {
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline uint64_t read_64(const Byte *p) {
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline uint32_t hash_32(uint32_t x) {
+    return (x * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Gets the number of equal bytes at p and q, up to limit.
+static inline size_t match_length(const Byte *p, const Byte *q, const Byte *limit) {
+    const Byte *start = p;
+    while (p + 8 <= limit) {
+        uint64_t diff = read_64(p) ^ read_64(q);
+        if (diff != 0) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return p - start + (__builtin_ctzll(diff) >> 3);
+#else
+            return p - start + (__builtin_clzll(diff) >> 3);
+#endif
+        }
+        p += 8;
+        q += 8;
+    }
+    while (p < limit && *p == *q) {
+        p++;
+        q++;
+    }
+    return p - start;
+}
+
+static inline Byte *write_length(Byte *op, size_t n) {
+    while (n >= 255) {
+        *op++ = 255;
+        n -= 255;
+    }
+    *op++ = n;
+    return op;
+}
+
+size_t lz_compress_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+size_t lz_compress(const Byte *src, size_t n, Byte *dst, size_t capacity) {
+    require("src not null", src != NULL || n == 0);
+    require_not_null(dst);
+    require("enough space", capacity >= lz_compress_bound(n));
+    uint32_t table[1 << HASH_BITS]; // positions of recent 4-byte sequences
+    memset(table, 0, sizeof(table));
+    const Byte *ip = src;
+    const Byte *anchor = src; // start of pending literals
+    const Byte *end = src + n;
+    const Byte *match_limit = n > LAST_LITERALS ? end - LAST_LITERALS : src;
+    Byte *op = dst;
+    while (ip + MIN_MATCH <= match_limit) {
+        uint32_t sequence = read_32(ip);
+        uint32_t h = hash_32(sequence);
+        const Byte *ref = src + table[h];
+        table[h] = ip - src;
+        if (ref >= ip || ip - ref > MAX_OFFSET || read_32(ref) != sequence) {
+            // skip faster through data that does not compress
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+        size_t length = MIN_MATCH + match_length(ip + MIN_MATCH, ref + MIN_MATCH, match_limit);
+        size_t literals = ip - anchor;
+        size_t extra = length - MIN_MATCH;
+        Byte *token = op++;
+        *token = ((literals < 15 ? literals : 15) << 4) | (extra < 15 ? extra : 15);
+        if (literals >= 15) op = write_length(op, literals - 15);
+        memcpy(op, anchor, literals);
+        op += literals;
+        size_t offset = ip - ref;
+        *op++ = offset & 0xff;
+        *op++ = offset >> 8;
+        if (extra >= 15) op = write_length(op, extra - 15);
+        ip += length;
+        anchor = ip;
+        // the position before the next one is likely to start a match later
+        if (ip - 2 >= src && ip + MIN_MATCH <= match_limit) table[hash_32(read_32(ip - 2))] = ip - 2 - src;
+    }
+    size_t literals = end - anchor;
+    *op++ = (literals < 15 ? literals : 15) << 4;
+    if (literals >= 15) op = write_length(op, literals - 15);
+    memcpy(op, anchor, literals);
+    op += literals;
+    return op - dst;
+}
+
+static void corrupt_data(void) {
+    fprintf(stderr, "lz_decompress: corrupt compressed data\n");
+    base_exit(EXIT_FAILURE);
+}
+
+// Reads the extension bytes of a length.
+static inline size_t read_length(const Byte **ip, const Byte *end) {
+    size_t n = 0;
+    Byte b;
+    do {
+        if (*ip >= end) corrupt_data();
+        b = *(*ip)++;
+        n += b;
+    } while (b == 255);
+    return n;
+}
+
+size_t lz_decompress(const Byte *src, size_t n, Byte *dst, size_t capacity) {
+    require("src not null", src != NULL || n == 0);
+    require("dst not null", dst != NULL || capacity == 0);
+    const Byte *ip = src;
+    const Byte *end = src + n;
+    Byte *op = dst;
+    Byte *op_end = dst + capacity;
+    while (ip < end) {
+        Byte token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15) literals += read_length(&ip, end);
+        if (literals <= 16 && end - ip >= 16 && op_end - op >= 16) {
+            memcpy(op, ip, 16); // a fixed-size copy is faster, the extra bytes are overwritten later
+        } else {
+            if (literals > (size_t)(end - ip) || literals > (size_t)(op_end - op)) corrupt_data();
+            memcpy(op, ip, literals);
+        }
+        ip += literals;
+        op += literals;
+        if (ip == end) break; // the last sequence has no match
+
+        if (end - ip < 2) corrupt_data();
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) corrupt_data();
+        size_t length = token & 15;
+        if (length == 15) length += read_length(&ip, end);
+        length += MIN_MATCH;
+        if (length > (size_t)(op_end - op)) corrupt_data();
+        const Byte *ref = op - offset;
+        if (offset >= 16 && (size_t)(op_end - op) >= length + 15) {
+            // copy in fixed-size pieces, each piece is complete before it is read
+            for (size_t i = 0; i < length; i += 16) memcpy(op + i, ref + i, 16);
+            op += length;
+            continue;
+        }
+        // The match may overlap the output, e.g., offset 1 repeats a byte. The
+        // bytes from ref to op repeat with period offset, so each copy may
+        // double in size.
+        while (length > 0) {
+            size_t k = op - ref;
+            if (k > length) k = length;
+            memcpy(op, ref, k);
+            op += k;
+            length -= k;
+        }
+    }
+    return op - dst;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Blocks
+
+#define STORED_FLAG 0x80000000u
+
+static void write_u32(Byte *p, uint32_t x) {
+    p[0] = x;
+    p[1] = x >> 8;
+    p[2] = x >> 16;
+    p[3] = x >> 24;
+}
+
+static uint32_t read_u32(const Byte *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t lz_block_bound(size_t n) {
+    return 8 + lz_compress_bound(n);
+}
+
+size_t lz_write_block(const Byte *src, size_t n, Byte *dst) {
+    require_not_null(src);
+    require_not_null(dst);
+    require("valid block size", n > 0 && n <= LZ_MAX_BLOCK_SIZE);
+    size_t k = lz_compress(src, n, dst + 8, lz_compress_bound(n));
+    if (k >= n) { // incompressible
+        memcpy(dst + 8, src, n);
+        write_u32(dst, n | STORED_FLAG);
+    } else {
+        write_u32(dst, k);
+    }
+    write_u32(dst + 4, n);
+    return 8 + (k >= n ? n : k);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Reader
+
+struct LzReader {
+    int fd; // file descriptor to read from
+    bool close_at_end; // whether the reader opened the file itself
+    bool eof; // whether the end marker has been read
+    Byte *packed; // the compressed block
+    size_t packed_capacity;
+    Byte *block; // the decompressed block
+    size_t block_capacity;
+    size_t position; // index of the next byte of block to return
+    size_t length; // number of valid bytes in block
+};
+
+// Reads exactly n bytes. Returns false at the end of the file before the first byte.
+static bool lz_read_fully(LzReader *r, Byte *p, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t k = read(r->fd, p + done, n - done);
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0) {
+            fprintf(stderr, "lz_read: Cannot read from file descriptor %d.\n", r->fd);
+            base_exit(EXIT_FAILURE);
+        }
+        if (k == 0) {
+            if (done == 0) return false;
+            corrupt_data();
+        }
+        done += k;
+        base_metric_add(BASE_METRIC_BYTES_READ, k);
+    }
+    return true;
+}
+
+LzReader *lz_of_fd(int fd) {
+    require("valid file descriptor", fd >= 0);
+    LzReader *r = xcalloc(1, sizeof(LzReader));
+    r->fd = fd;
+    Byte magic[4];
+    if (!lz_read_fully(r, magic, sizeof(magic)) || memcmp(magic, LZ_MAGIC, sizeof(magic)) != 0) {
+        fprintf(stderr, "lz_open: not a compressed file\n");
+        base_exit(EXIT_FAILURE);
+    }
+    return r;
+}
+
+LzReader *lz_open(String name) {
+    require_not_null(name);
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "lz_open: Cannot open %s\n", name);
+        base_exit(EXIT_FAILURE);
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    LzReader *r = lz_of_fd(fd);
+    r->close_at_end = true;
+    return r;
+}
+
+// Reads and decompresses the next block, directly into target if it fits,
+// otherwise into the block buffer of the reader. Returns the size of the
+// block, 0 at the end marker.
+static size_t lz_next_block(LzReader *r, Byte *target, size_t capacity) {
+    Byte header[8];
+    if (!lz_read_fully(r, header, 4)) corrupt_data(); // missing end marker
+    uint32_t packed_size = read_u32(header);
+    if (packed_size == 0) return 0;
+    if (!lz_read_fully(r, header + 4, 4)) corrupt_data();
+    size_t size = read_u32(header + 4);
+    bool stored = (packed_size & STORED_FLAG) != 0;
+    packed_size &= ~STORED_FLAG;
+    if (size == 0 || size > LZ_MAX_BLOCK_SIZE || packed_size > lz_compress_bound(size)) corrupt_data();
+    Byte *out = target;
+    if (size > capacity) {
+        if (size > r->block_capacity) {
+            if (r->block != NULL) free(r->block);
+            r->block = xmalloc(size);
+            r->block_capacity = size;
+        }
+        out = r->block;
+        r->position = 0;
+        r->length = size;
+    }
+    if (stored) {
+        if (packed_size != size || !lz_read_fully(r, out, size)) corrupt_data();
+    } else {
+        if (packed_size > r->packed_capacity) {
+            if (r->packed != NULL) free(r->packed);
+            r->packed = xmalloc(packed_size);
+            r->packed_capacity = packed_size;
+        }
+        if (!lz_read_fully(r, r->packed, packed_size)) corrupt_data();
+        if (lz_decompress(r->packed, packed_size, out, size) != size) corrupt_data();
+    }
+    return size;
+}
+
+size_t lz_read(LzReader *r, void *data, size_t n) {
+    require_not_null(r);
+    require("data not null", data != NULL || n == 0);
+    Byte *p = data;
+    size_t done = 0;
+    while (done < n) {
+        if (r->position == r->length) {
+            if (r->eof) break;
+            size_t k = lz_next_block(r, p + done, n - done);
+            if (k == 0) {
+                r->eof = true;
+                break;
+            }
+            if (k <= n - done) { // decompressed directly into data
+                done += k;
+                continue;
+            }
+        }
+        size_t k = r->length - r->position;
+        if (k > n - done) k = n - done;
+        memcpy(p + done, r->block + r->position, k);
+        r->position += k;
+        done += k;
+    }
+    return done;
+}
+
+void lz_close(LzReader *r) {
+    require_not_null(r);
+    if (r->close_at_end) close(r->fd);
+    if (r->packed != NULL) free(r->packed);
+    if (r->block != NULL) free(r->block);
+    free(r);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Whole files
+
+void write_file_compressed(String name, const Byte *data, size_t n) {
+    require_not_null(name);
+    require("data not null", data != NULL || n == 0);
+    FileWriter *w = fw_open(name, FW_ATOMIC | FW_COMPRESS, 0);
+    if (n > 0) fw_write(w, data, n);
+    fw_close(w);
+}
+
+Byte *read_file_compressed(String name, size_t *n) {
+    require_not_null(name);
+    require_not_null(n);
+    LzReader *r = lz_open(name);
+    // start with the compressed size and double as needed, since xmalloc fills
+    // the whole buffer but xrealloc does not fill the added part
+    struct stat st;
+    size_t capacity = (fstat(r->fd, &st) == 0 && st.st_size > 0) ? st.st_size + 4096 : 4096;
+    Byte *data = xmalloc(capacity);
+    size_t length = 0;
+    for (;;) {
+        if (length + 1 >= capacity) {
+            capacity *= 2;
+            data = xrealloc(data, capacity);
+        }
+        size_t k = lz_read(r, data + length, capacity - 1 - length);
+        if (k == 0) break;
+        length += k;
+    }
+    lz_close(r);
+    data[length] = '\0';
+    *n = length;
+    return data;
+}
+
+void s_write_file_compressed(String name, String s) {
+    require_not_null(s);
+    write_file_compressed(name, (const Byte*)s, strlen(s));
+}
+
+String s_read_file_compressed(String name) {
+    size_t n;
+    return (String)read_file_compressed(name, &n);
+}
@@ -0,0 +1,152 @@
+/** @file
+Fast compression of text and data with an LZ77-style codec. The codec replaces repeated byte sequences by references to their previous occurrence within the last 64 KB. It is not as strong as gzip, but compresses and decompresses at several hundred MB/s, which is usually faster than reading and writing the uncompressed data.
+
+Example: Write and read a compressed text file.
+@code{.c}
+s_write_file_compressed("dump.txt.lz", "hello hello hello hello\n");
+String s = s_read_file_compressed("dump.txt.lz");
+prints(s);
+free(s);
+@endcode
+
+Example: Write a compressed file line by line and read it back.
+@code{.c}
+FileWriter *w = fw_open("squares.txt.lz", FW_COMPRESS, 0);
+for (int i = 0; i < 1000000; i++) fw_printf(w, "%d\n", i * i);
+fw_close(w);
+
+LineReader *r = lr_open_compressed("squares.txt.lz", 0);
+StringView line;
+while (lr_next(r, &line)) { ... }
+lr_close(r);
+@endcode
+
+A compressed file starts with the four bytes @c "PLZ1", followed by blocks. Each block starts with its compressed size (bits 0 to 30) and its uncompressed size as 32-bit little endian numbers. If bit 31 of the compressed size is set, the block is stored uncompressed. A compressed size of 0 ends the file, without uncompressed size. The blocks are compressed independently of each other.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __COMPRESS_H__
+#define __COMPRESS_H__
+
+#include "base.h"
+
+/** The first bytes of a compressed file. */
+#define LZ_MAGIC "PLZ1"
+
+/** Largest uncompressed size of a block that readers accept. */
+#define LZ_MAX_BLOCK_SIZE (1 << 30)
+
+/**
+Gets the largest possible size of @c n bytes after compression, for incompressible data.
+@param[in] n number of bytes
+@return the size of a buffer that can hold the compressed bytes
+*/
+size_t lz_compress_bound(size_t n);
+
+/**
+Compresses a buffer.
+@param[in] src the bytes to compress
+@param[in] n number of bytes to compress
+@param[out] dst the compressed bytes
+@param[in] capacity size of @c dst
+@return number of compressed bytes
+@pre "enough space", capacity >= lz_compress_bound(n)
+*/
+size_t lz_compress(const Byte *src, size_t n, Byte *dst, size_t capacity);
+
+/**
+Decompresses a buffer that has been compressed with @ref lz_compress. Exits the program if the data is corrupt or does not fit into @c dst.
+@param[in] src the compressed bytes
+@param[in] n number of compressed bytes
+@param[out] dst the decompressed bytes
+@param[in] capacity size of @c dst
+@return number of decompressed bytes
+*/
+size_t lz_decompress(const Byte *src, size_t n, Byte *dst, size_t capacity);
+
+/**
+Gets the largest possible size of a block of a compressed file (including its 8 byte header) for @c n uncompressed bytes.
+@param[in] n number of bytes
+@return the size of a buffer that can hold the block
+*/
+size_t lz_block_bound(size_t n);
+
+/**
+Compresses a block of a compressed file, including its header. Stores the block uncompressed if compression does not make it smaller.
+@param[in] src the bytes to compress
+@param[in] n number of bytes to compress
+@param[out] dst the block, at least @ref lz_block_bound bytes
+@return number of bytes of the block
+@pre "valid block size", n > 0 && n <= LZ_MAX_BLOCK_SIZE
+*/
+size_t lz_write_block(const Byte *src, size_t n, Byte *dst);
+
+/**
+Reads a compressed file and decompresses its blocks.
+@see lz_open, lz_of_fd, lz_read, lz_close
+*/
+typedef struct LzReader LzReader;
+
+/**
+Opens a compressed file for reading. Exits the program if the file cannot be opened or is not a compressed file.
+@param[in] name file name (including path)
+@return the reader, close it with @ref lz_close
+*/
+LzReader *lz_open(String name);
+
+/**
+Creates a reader for a compressed stream from an open file descriptor. The file descriptor is not closed by @ref lz_close.
+@param[in] fd file descriptor to read from
+@return the reader, close it with @ref lz_close
+*/
+LzReader *lz_of_fd(int fd);
+
+/**
+Reads up to @c n decompressed bytes. Exits the program if the compressed data is corrupt.
+@param[in,out] r the reader
+@param[out] data the decompressed bytes
+@param[in] n maximum number of bytes to read
+@return number of bytes read, 0 at the end of the compressed stream
+*/
+size_t lz_read(LzReader *r, void *data, size_t n);
+
+/**
+Closes the reader and frees its memory. Closes the file if it has been opened with @ref lz_open.
+@param[in] r the reader
+*/
+void lz_close(LzReader *r);
+
+/**
+Writes data to a compressed file. The file is replaced atomically.
+@param[in] name file name (including path)
+@param[in] data the bytes to write
+@param[in] n number of bytes
+*/
+void write_file_compressed(String name, const Byte *data, size_t n);
+
+/**
+Reads and decompresses a compressed file.
+@param[in] name file name (including path)
+@param[out] n number of decompressed bytes
+@return the decompressed bytes, zero-terminated, free them with @ref free
+*/
+Byte *read_file_compressed(String name, size_t *n);
+
+/**
+Writes a String to a compressed file, like @ref s_write_file.
+@param[in] name file name (including path)
+@param[in] s the String to write
+*/
+void s_write_file_compressed(String name, String s);
+
+/**
+Reads and decompresses a compressed file into a String, like @ref s_read_file.
+@param[in] name file name (including path)
+@return the contents of the file, free it with @ref free
+*/
+String s_read_file_compressed(String name);
+
+#endif
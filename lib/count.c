@@ -0,0 +1,152 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "count.h"
+
+TextCounts make_text_counts(void) {
+    TextCounts c = { 0, 0, 0, 0, false };
+    return c;
+}
+
+static bool is_space(Byte b) {
+    return b == ' ' || (b >= '\t' && b <= '\r');
+}
+
+// Counts byte by byte, for the bytes that do not fill a vector.
+static void count_scalar(TextCounts *c, const Byte *p, size_t n) {
+    bool in_word = c->in_word;
+    for (size_t i = 0; i < n; i++) {
+        Byte b = p[i];
+        bool space = is_space(b);
+        c->lines += b == '\n';
+        c->words += !space && !in_word;
+        c->chars += (b & 0xc0) != 0x80;
+        in_word = !space;
+    }
+    c->in_word = in_word;
+}
+
+#ifdef __SSE2__
+
+typedef struct Masks {
+    uint64_t lines; // line breaks
+    uint64_t spaces; // white space
+    uint64_t continuations; // UTF-8 continuation bytes
+} Masks;
+
+// Sets one bit per byte for the 64 bytes at p.
+static inline __attribute__((always_inline)) Masks masks_64(const Byte *p) {
+    Masks m = { 0, 0, 0 };
+    for (int k = 0; k < 4; k++) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p + 16 * k));
+        // '\t' to '\r' are consecutive, so x - '\t' <= '\r' - '\t' (unsigned)
+        __m128i y = _mm_sub_epi8(x, _mm_set1_epi8('\t'));
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(y, _mm_set1_epi8('\r' - '\t')), y);
+        __m128i space = _mm_or_si128(control, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+        // 0x80 to 0xbf are the signed bytes less than (char)0xc0
+        __m128i continuation = _mm_cmplt_epi8(x, _mm_set1_epi8((char)0xc0));
+        __m128i line = _mm_cmpeq_epi8(x, _mm_set1_epi8('\n'));
+        m.lines |= (uint64_t)(uint16_t)_mm_movemask_epi8(line) << (16 * k);
+        m.spaces |= (uint64_t)(uint16_t)_mm_movemask_epi8(space) << (16 * k);
+        m.continuations |= (uint64_t)(uint16_t)_mm_movemask_epi8(continuation) << (16 * k);
+    }
+    return m;
+}
+
+// Counts 64 bytes per step, the rest byte by byte. A word starts at a
+// non-space byte that follows a space byte.
+static inline __attribute__((always_inline)) void count_vectors(TextCounts *c, const Byte *p, size_t n) {
+    uint64_t previous_space = !c->in_word;
+    size_t lines = 0, words = 0, continuations = 0;
+    size_t m = n & ~(size_t)63;
+    for (size_t i = 0; i < m; i += 64) {
+        Masks k = masks_64(p + i);
+        lines += __builtin_popcountll(k.lines);
+        words += __builtin_popcountll(~k.spaces & ((k.spaces << 1) | previous_space));
+        continuations += __builtin_popcountll(k.continuations);
+        previous_space = k.spaces >> 63;
+    }
+    c->lines += lines;
+    c->words += words;
+    c->chars += m - continuations;
+    if (m > 0) c->in_word = !previous_space;
+    count_scalar(c, p + m, n - m);
+}
+
+// The same loop, compiled with the popcnt instruction rather than a library call.
+__attribute__((target("popcnt")))
+static void count_popcnt(TextCounts *c, const Byte *p, size_t n) {
+    count_vectors(c, p, n);
+}
+
+static void count_sse2(TextCounts *c, const Byte *p, size_t n) {
+    count_vectors(c, p, n);
+}
+
+#endif
+
+void count_text(TextCounts *c, const Byte *data, size_t n) {
+    require_not_null(c);
+    require("data not null", data != NULL || n == 0);
+    c->bytes += n;
+#ifdef __SSE2__
+    static int has_popcnt = -1;
+    if (has_popcnt < 0) has_popcnt = __builtin_cpu_supports("popcnt");
+    if (has_popcnt) {
+        count_popcnt(c, data, n);
+    } else {
+        count_sse2(c, data, n);
+    }
+#else
+    count_scalar(c, data, n);
+#endif
+}
+
+TextCounts count_buffer(const Byte *data, size_t n) {
+    TextCounts c = make_text_counts();
+    count_text(&c, data, n);
+    return c;
+}
+
+TextCounts count_fd(int fd) {
+    require("valid file descriptor", fd >= 0);
+    int capacity = 1024 * 1024;
+    Byte *buffer = xmalloc(capacity);
+    TextCounts c = make_text_counts();
+    for (;;) {
+        ssize_t k = read(fd, buffer, capacity);
+        if (k == 0) break;
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "%s: Cannot read from file descriptor %d.\n", (String)__func__, fd);
+            base_exit(EXIT_FAILURE);
+        }
+        base_metric_add(BASE_METRIC_BYTES_READ, k);
+        count_text(&c, buffer, k);
+    }
+    free(buffer);
+    return c;
+}
+
+TextCounts count_file(String name) {
+    require_not_null(name);
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: Cannot open %s\n", (String)__func__, name);
+        base_exit(EXIT_FAILURE);
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    TextCounts c = count_fd(fd);
+    close(fd);
+    return c;
+}
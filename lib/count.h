@@ -0,0 +1,76 @@
+/** @file
+Counting lines, words, and characters, like the @c wc command. The counting functions process 64 bytes at a time with vector instructions (SSE2) where available.
+
+Example: Count the lines, words, and characters of standard input.
+@code{.c}
+TextCounts c = count_fd(0);
+printf("%lu %lu %lu\n", (unsigned long)c.lines, (unsigned long)c.words, (unsigned long)c.chars);
+@endcode
+
+Example: Count text that arrives in pieces.
+@code{.c}
+TextCounts c = make_text_counts();
+count_text(&c, (Byte*)"hello wo", 8);
+count_text(&c, (Byte*)"rld\n", 4);
+// c.lines == 1, c.words == 2, c.chars == 12, c.bytes == 12
+@endcode
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __COUNT_H__
+#define __COUNT_H__
+
+#include "base.h"
+
+/**
+The counts of a text. Lines are counted as line breaks (@c '\\n'). Words are sequences of characters that are separated by white space (space, @c '\\t', @c '\\n', @c '\\v', @c '\\f', @c '\\r'). Characters are UTF-8 encoded characters, i.e., all bytes except UTF-8 continuation bytes.
+@see make_text_counts, count_text
+*/
+typedef struct TextCounts {
+    size_t lines; ///< number of line breaks
+    size_t words; ///< number of words
+    size_t chars; ///< number of UTF-8 characters
+    size_t bytes; ///< number of bytes
+    bool in_word; ///< whether the text counted so far ends within a word
+} TextCounts;
+
+/**
+Creates counts of zero, for counting a new text.
+@return the counts
+*/
+TextCounts make_text_counts(void);
+
+/**
+Counts the next piece of a text. A word may span several pieces.
+@param[in,out] c the counts so far, updated to include the piece
+@param[in] data the bytes of the piece
+@param[in] n number of bytes
+*/
+void count_text(TextCounts *c, const Byte *data, size_t n);
+
+/**
+Counts a whole text.
+@param[in] data the bytes of the text
+@param[in] n number of bytes
+@return the counts
+*/
+TextCounts count_buffer(const Byte *data, size_t n);
+
+/**
+Counts all remaining input of a file descriptor, e.g., 0 for standard input. Reads in large blocks.
+@param[in] fd file descriptor to read from
+@return the counts
+*/
+TextCounts count_fd(int fd);
+
+/**
+Counts the contents of the file with the given name. Exits the program if the file cannot be opened.
+@param[in] name file name (including path)
+@return the counts
+*/
+TextCounts count_file(String name);
+
+#endif
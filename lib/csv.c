@@ -0,0 +1,385 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <limits.h>
+#include <stdint.h>
+#include "csv.h"
+#include "mapfile.h"
+#include "parse.h"
+
+// Number of rows used to infer the types of the columns.
+#define INFER_ROWS 100
+
+////////////////////////////////////////////////////////////////////////////
+// Interned strings
+
+#define POOL_BLOCK_SIZE (1024 * 1024)
+
+typedef struct PoolEntry {
+    uint64_t hash;
+    String s;
+} PoolEntry;
+
+// Stores each distinct string once, in large blocks.
+typedef struct StringPool {
+    char **blocks;
+    int n_blocks;
+    int blocks_capacity;
+    size_t used; // bytes used in the last block
+    size_t block_capacity; // size of the last block
+    PoolEntry *table; // hash table with linear probing
+    size_t table_capacity; // a power of two
+    size_t count;
+} StringPool;
+
+static StringPool *new_string_pool(void) {
+    StringPool *pool = xcalloc(1, sizeof(StringPool));
+    pool->blocks_capacity = 16;
+    pool->blocks = xmalloc(pool->blocks_capacity * sizeof(char*));
+    pool->table_capacity = 1024;
+    pool->table = xcalloc(pool->table_capacity, sizeof(PoolEntry));
+    return pool;
+}
+
+static void free_string_pool(StringPool *pool) {
+    for (int i = 0; i < pool->n_blocks; i++) free(pool->blocks[i]);
+    free(pool->blocks);
+    free(pool->table);
+    free(pool);
+}
+
+static uint64_t hash_chars(const char *s, int n) {
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    for (int i = 0; i < n; i++) h = (h ^ (Byte)s[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+// Copies the characters into the current block, starts a new block if they do not fit.
+static String pool_store(StringPool *pool, const char *s, int n) {
+    if (pool->n_blocks == 0 || pool->used + n + 1 > pool->block_capacity) {
+        if (pool->n_blocks == pool->blocks_capacity) {
+            pool->blocks_capacity *= 2;
+            pool->blocks = xrealloc(pool->blocks, pool->blocks_capacity * sizeof(char*));
+        }
+        pool->block_capacity = (size_t)n + 1 > POOL_BLOCK_SIZE ? (size_t)n + 1 : POOL_BLOCK_SIZE;
+        pool->blocks[pool->n_blocks++] = xmalloc(pool->block_capacity);
+        pool->used = 0;
+    }
+    String copy = pool->blocks[pool->n_blocks - 1] + pool->used;
+    memcpy(copy, s, n);
+    copy[n] = '\0';
+    pool->used += n + 1;
+    return copy;
+}
+
+static void pool_grow(StringPool *pool) {
+    size_t capacity = 2 * pool->table_capacity;
+    PoolEntry *table = xcalloc(capacity, sizeof(PoolEntry));
+    for (size_t i = 0; i < pool->table_capacity; i++) {
+        PoolEntry e = pool->table[i];
+        if (e.s == NULL) continue;
+        size_t j = e.hash & (capacity - 1);
+        while (table[j].s != NULL) j = (j + 1) & (capacity - 1);
+        table[j] = e;
+    }
+    free(pool->table);
+    pool->table = table;
+    pool->table_capacity = capacity;
+}
+
+// Gets the stored copy of the characters, stores them if they are new.
+static String pool_intern(StringPool *pool, const char *s, int n) {
+    uint64_t h = hash_chars(s, n);
+    size_t mask = pool->table_capacity - 1;
+    size_t i = h & mask;
+    while (pool->table[i].s != NULL) {
+        PoolEntry e = pool->table[i];
+        if (e.hash == h && memcmp(e.s, s, n) == 0 && e.s[n] == '\0') return e.s;
+        i = (i + 1) & mask;
+    }
+    String copy = pool_store(pool, s, n);
+    pool->table[i].hash = h;
+    pool->table[i].s = copy;
+    pool->count++;
+    if (2 * pool->count > pool->table_capacity) pool_grow(pool);
+    return copy;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Records
+
+typedef struct CsvParser {
+    String name; // file name for error messages
+    const char *p; // next character
+    const char *end; // end of the input
+    char separator;
+    long line; // line number of the next character
+    long record_line; // line number of the start of the current record
+    StringView *fields; // the fields of the current record
+    int *unescaped; // offset of the field in scratch, or -1 if the field points into the input
+    int n_fields;
+    int fields_capacity;
+    char *scratch; // quoted fields with "" in them, without the extra quotes
+    int scratch_length;
+    int scratch_capacity;
+} CsvParser;
+
+static void csv_fail(CsvParser *r, String message) {
+    fprintf(stderr, "csv_read_file: %s at line %ld of %s\n", message, r->record_line, r->name);
+    base_exit(EXIT_FAILURE);
+}
+
+static void add_field(CsvParser *r, const char *s, int n, int unescaped) {
+    if (r->n_fields == r->fields_capacity) {
+        r->fields_capacity *= 2;
+        r->fields = xrealloc(r->fields, r->fields_capacity * sizeof(StringView));
+        r->unescaped = xrealloc(r->unescaped, r->fields_capacity * sizeof(int));
+    }
+    r->fields[r->n_fields] = make_string_view(s, n);
+    r->unescaped[r->n_fields] = unescaped;
+    r->n_fields++;
+}
+
+static void append_scratch(CsvParser *r, const char *s, int n) {
+    if (r->scratch_length + n > r->scratch_capacity) {
+        while (r->scratch_length + n > r->scratch_capacity) r->scratch_capacity *= 2;
+        r->scratch = xrealloc(r->scratch, r->scratch_capacity);
+    }
+    memcpy(r->scratch + r->scratch_length, s, n);
+    r->scratch_length += n;
+}
+
+// Parses a quoted field, r->p is after the opening quote.
+static void parse_quoted_field(CsvParser *r) {
+    const char *start = r->p;
+    int unescaped = -1;
+    for (;;) {
+        const char *q = memchr(r->p, '"', r->end - r->p);
+        if (q == NULL) csv_fail(r, "unterminated quoted field");
+        for (const char *s = r->p; (s = memchr(s, '\n', q - s)) != NULL; s++) r->line++;
+        if (q + 1 < r->end && q[1] == '"') { // "" stands for "
+            if (unescaped < 0) unescaped = r->scratch_length;
+            append_scratch(r, r->p, q + 1 - r->p);
+            r->p = q + 2;
+            continue;
+        }
+        if (unescaped < 0) {
+            add_field(r, start, q - start, -1);
+        } else {
+            append_scratch(r, r->p, q - r->p);
+            add_field(r, r->scratch + unescaped, r->scratch_length - unescaped, unescaped);
+        }
+        r->p = q + 1;
+        return;
+    }
+}
+
+// Parses the next record into r->fields. Returns false at the end of the input.
+static bool next_record(CsvParser *r) {
+    while (r->p < r->end && (*r->p == '\n' || *r->p == '\r')) {
+        if (*r->p == '\n') r->line++;
+        r->p++;
+    }
+    if (r->p == r->end) return false;
+    r->record_line = r->line;
+    r->n_fields = 0;
+    r->scratch_length = 0;
+    char separator = r->separator;
+    for (;;) {
+        if (r->p < r->end && *r->p == '"') {
+            r->p++;
+            parse_quoted_field(r);
+        } else {
+            const char *start = r->p;
+            const char *p = start;
+            const char *end = r->end;
+            while (p < end && *p != separator && *p != '\n' && *p != '\r') p++;
+            add_field(r, start, p - start, -1);
+            r->p = p;
+        }
+        if (r->p == r->end) break;
+        char c = *r->p++;
+        if (c == separator) continue;
+        if (c == '\r' && r->p < r->end && *r->p == '\n') c = *r->p++;
+        if (c == '\n') {
+            r->line++;
+            break;
+        }
+        if (c != '\r') csv_fail(r, "unexpected character after quoted field");
+        break;
+    }
+    // the scratch buffer may have moved while adding fields
+    for (int i = 0; i < r->n_fields; i++) {
+        if (r->unescaped[i] >= 0) r->fields[i].s = r->scratch + r->unescaped[i];
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Columns
+
+// Removes spaces around a number.
+static StringView trim(StringView v) {
+    while (v.length > 0 && (*v.s == ' ' || *v.s == '\t')) {
+        v.s++;
+        v.length--;
+    }
+    while (v.length > 0 && (v.s[v.length - 1] == ' ' || v.s[v.length - 1] == '\t')) v.length--;
+    return v;
+}
+
+static ColumnType infer_type(CsvParser *r, int column, int n_columns) {
+    const char *p = r->p;
+    long line = r->line;
+    ColumnType type = COLUMN_INT;
+    for (int row = 0; row < INFER_ROWS && next_record(r); row++) {
+        if (r->n_fields != n_columns) break; // reported when reading the rows
+        StringView v = trim(r->fields[column]);
+        if (v.length == 0) continue;
+        int i;
+        double d;
+        if (type == COLUMN_INT && !parse_int(v.s, v.length, &i)) type = COLUMN_DOUBLE;
+        if (type == COLUMN_DOUBLE && !parse_double(v.s, v.length, &d)) {
+            type = COLUMN_STRING;
+            break;
+        }
+    }
+    r->p = p;
+    r->line = line;
+    return type;
+}
+
+static void malformed_field(CsvParser *r, String type, StringView v, int column) {
+    fprintf(stderr, "csv_read_file: malformed %s \"%.*s\" at line %ld, column %d of %s\n",
+        type, v.length < 40 ? v.length : 40, v.s, r->record_line, column + 1, r->name);
+    base_exit(EXIT_FAILURE);
+}
+
+CsvTable *csv_read_file(String name, char separator, bool header, const ColumnType *types) {
+    require_not_null(name);
+    require("valid separator", separator != '"' && separator != '\n' && separator != '\r');
+    MappedFile m = map_file(name, ADVICE_SEQUENTIAL);
+    CsvParser r;
+    memset(&r, 0, sizeof(r));
+    r.name = name;
+    r.p = (const char*)m.data;
+    r.end = r.p + m.size;
+    r.separator = separator;
+    r.line = 1;
+    r.fields_capacity = 16;
+    r.fields = xmalloc(r.fields_capacity * sizeof(StringView));
+    r.unescaped = xmalloc(r.fields_capacity * sizeof(int));
+    r.scratch_capacity = 1024;
+    r.scratch = xmalloc(r.scratch_capacity);
+
+    CsvTable *t = xcalloc(1, sizeof(CsvTable));
+    StringPool *pool = new_string_pool();
+    t->strings = pool;
+    const char *data_start = r.p;
+    long data_line = r.line;
+    if (!next_record(&r)) {
+        csv_fail(&r, "empty file");
+    }
+    t->n_columns = r.n_fields;
+    t->columns = xcalloc(t->n_columns, sizeof(CsvColumn));
+    if (header) {
+        for (int j = 0; j < t->n_columns; j++) {
+            t->columns[j].name = pool_intern(pool, r.fields[j].s, r.fields[j].length);
+        }
+    } else {
+        r.p = data_start;
+        r.line = data_line;
+    }
+
+    int capacity = 1024;
+    for (int j = 0; j < t->n_columns; j++) {
+        CsvColumn *c = &t->columns[j];
+        c->type = types != NULL ? types[j] : infer_type(&r, j, t->n_columns);
+        switch (c->type) {
+            case COLUMN_INT: c->ints = xmalloc(capacity * sizeof(int)); break;
+            case COLUMN_DOUBLE: c->doubles = xmalloc(capacity * sizeof(double)); break;
+            case COLUMN_STRING: c->strings = xmalloc(capacity * sizeof(String)); break;
+        }
+    }
+
+    int n = 0;
+    while (next_record(&r)) {
+        if (r.n_fields != t->n_columns) {
+            fprintf(stderr, "csv_read_file: %d fields instead of %d at line %ld of %s\n",
+                r.n_fields, t->n_columns, r.record_line, name);
+            base_exit(EXIT_FAILURE);
+        }
+        if (n == capacity) {
+            capacity *= 2;
+            for (int j = 0; j < t->n_columns; j++) {
+                CsvColumn *c = &t->columns[j];
+                switch (c->type) {
+                    case COLUMN_INT: c->ints = xrealloc(c->ints, capacity * sizeof(int)); break;
+                    case COLUMN_DOUBLE: c->doubles = xrealloc(c->doubles, capacity * sizeof(double)); break;
+                    case COLUMN_STRING: c->strings = xrealloc(c->strings, capacity * sizeof(String)); break;
+                }
+            }
+        }
+        for (int j = 0; j < t->n_columns; j++) {
+            CsvColumn *c = &t->columns[j];
+            StringView v = r.fields[j];
+            switch (c->type) {
+                case COLUMN_INT:
+                    v = trim(v);
+                    if (v.length == 0) {
+                        c->ints[n] = 0;
+                    } else if (!parse_int(v.s, v.length, &c->ints[n])) {
+                        malformed_field(&r, "int", v, j);
+                    }
+                    break;
+                case COLUMN_DOUBLE:
+                    v = trim(v);
+                    if (v.length == 0) {
+                        c->doubles[n] = NAN;
+                    } else if (!parse_double(v.s, v.length, &c->doubles[n])) {
+                        malformed_field(&r, "double", v, j);
+                    }
+                    break;
+                case COLUMN_STRING:
+                    c->strings[n] = pool_intern(pool, v.s, v.length);
+                    break;
+            }
+        }
+        n++;
+        if (n == INT_MAX) csv_fail(&r, "too many rows");
+    }
+    t->n_rows = n;
+
+    free(r.fields);
+    free(r.unescaped);
+    free(r.scratch);
+    unmap_file(&m);
+    return t;
+}
+
+int csv_column_index(CsvTable *t, String name) {
+    require_not_null(t);
+    require_not_null(name);
+    for (int j = 0; j < t->n_columns; j++) {
+        if (t->columns[j].name != NULL && strcmp(t->columns[j].name, name) == 0) return j;
+    }
+    return -1;
+}
+
+void csv_free(CsvTable *t) {
+    require_not_null(t);
+    for (int j = 0; j < t->n_columns; j++) {
+        CsvColumn *c = &t->columns[j];
+        switch (c->type) {
+            case COLUMN_INT: free(c->ints); break;
+            case COLUMN_DOUBLE: free(c->doubles); break;
+            case COLUMN_STRING: free(c->strings); break;
+        }
+    }
+    free(t->columns);
+    free_string_pool(t->strings);
+    free(t);
+}
@@ -0,0 +1,87 @@
+/** @file
+Reading CSV files into typed columns. Each column of the file becomes an array of ints, doubles, or Strings. The file is mapped into memory and parsed in a single pass, without allocating memory per field. Equal Strings of a column are stored only once (interned), so comparing them with @c == is enough.
+
+Example: Compute the average of a column.
+@code{.c}
+// prices.csv:
+// item,count,price
+// apple,3,0.5
+// "pear, green",2,0.75
+CsvTable *t = csv_read_file("prices.csv", ',', true, NULL);
+int price = csv_column_index(t, "price");
+double sum = 0;
+for (int i = 0; i < t->n_rows; i++) sum += t->columns[price].doubles[i];
+printdln(sum / t->n_rows);
+csv_free(t);
+@endcode
+
+Fields may be quoted with @c '"'. Quoted fields may contain separators, line breaks, and quotes, which are written as two quotes (@c ""). Lines end with @c "\n" or @c "\r\n". Empty lines are skipped. Numbers may be surrounded by spaces. An empty field is 0 in an int column, NAN in a double column, and "" in a String column.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __CSV_H__
+#define __CSV_H__
+
+#include "base.h"
+
+/**
+The type of the values of a column.
+*/
+typedef enum ColumnType {
+    COLUMN_INT, ///< int values, parsed with @ref parse_int
+    COLUMN_DOUBLE, ///< double values, parsed with @ref parse_double
+    COLUMN_STRING ///< interned Strings
+} ColumnType;
+
+/**
+A column of a CSV table.
+*/
+typedef struct CsvColumn {
+    String name; ///< the name from the header line, or NULL if there is none
+    ColumnType type; ///< the type of the values
+    union {
+        int *ints; ///< the values, if the type is COLUMN_INT
+        double *doubles; ///< the values, if the type is COLUMN_DOUBLE
+        String *strings; ///< the values, if the type is COLUMN_STRING (do not free them)
+    };
+} CsvColumn;
+
+/**
+The contents of a CSV file, column by column.
+@see csv_read_file, csv_column_index, csv_free
+*/
+typedef struct CsvTable {
+    int n_rows; ///< number of rows, not counting the header line
+    int n_columns; ///< number of columns
+    CsvColumn *columns; ///< the columns
+    Any strings; ///< storage of the interned Strings
+} CsvTable;
+
+/**
+Reads a CSV file into typed columns. If the types are not given, they are inferred from the first 100 rows: a column is an int column if all these fields are ints, a double column if they are all numbers, and a String column otherwise. Exits the program with an error message stating the line if the file cannot be read, a row has the wrong number of fields, or a field does not match the type of its column.
+@param[in] name file name (including path)
+@param[in] separator the character that separates fields, e.g., ',' or ';' or '\\t'
+@param[in] header whether the first line contains the names of the columns
+@param[in] types the types of the columns, or NULL to infer them
+@return the table, free it with @ref csv_free
+*/
+CsvTable *csv_read_file(String name, char separator, bool header, const ColumnType *types);
+
+/**
+Finds a column by name.
+@param[in] t the table
+@param[in] name the name of the column
+@return the index of the column, or -1 if there is no such column
+*/
+int csv_column_index(CsvTable *t, String name);
+
+/**
+Frees the table, including its columns and Strings.
+@param[in] t the table
+*/
+void csv_free(CsvTable *t);
+
+#endif
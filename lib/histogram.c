@@ -0,0 +1,264 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include "histogram.h"
+
+// The layout of the counts: Bucket 0 holds the values 0 to 2^m - 1, one count per
+// value, where 2^m >= 2 * 10^digits. Bucket b > 0 holds the values 2^(m-1+b) to
+// 2^(m+b) - 1 in 2^(m-1) counts, each 2^b wide. The lower half of a bucket b > 0
+// would overlap with bucket b - 1, so only its upper half is stored.
+
+static int bucket_of(const Histogram *h, int64_t value) {
+    int64_t mask = ((int64_t)1 << h->sub_bucket_magnitude) - 1;
+    return 64 - __builtin_clzll(value | mask) - h->sub_bucket_magnitude;
+}
+
+static int index_of(const Histogram *h, int64_t value) {
+    int half_magnitude = h->sub_bucket_magnitude - 1;
+    int bucket = bucket_of(h, value);
+    int sub_bucket = value >> bucket;
+    return ((bucket + 1) << half_magnitude) + sub_bucket - (1 << half_magnitude);
+}
+
+// The smallest value that is counted at the index.
+static int64_t value_of(const Histogram *h, int index) {
+    int half_magnitude = h->sub_bucket_magnitude - 1;
+    int bucket = (index >> half_magnitude) - 1;
+    int64_t sub_bucket = (index & ((1 << half_magnitude) - 1)) + (1 << half_magnitude);
+    if (bucket < 0) {
+        sub_bucket -= 1 << half_magnitude;
+        bucket = 0;
+    }
+    return sub_bucket << bucket;
+}
+
+// The number of values that are counted at the same index as the value.
+static int64_t width_of(const Histogram *h, int64_t value) {
+    return (int64_t)1 << bucket_of(h, value);
+}
+
+Histogram *hist_new(int64_t highest, int digits) {
+    require("highest value at least 2", highest >= 2);
+    require("1 to 5 significant digits", digits >= 1 && digits <= 5);
+    int64_t sub_buckets = 2;
+    for (int i = 0; i < digits; i++) sub_buckets *= 10;
+    int magnitude = 0;
+    while (((int64_t)1 << magnitude) < sub_buckets) magnitude++;
+    // the number of buckets needed to reach the highest value
+    int n_buckets = 1;
+    while ((highest >> (magnitude + n_buckets - 1)) > 0) n_buckets++;
+    Histogram *h = xcalloc(1, sizeof(Histogram));
+    h->highest = highest;
+    h->digits = digits;
+    h->sub_bucket_magnitude = magnitude;
+    h->n_counts = (n_buckets + 1) << (magnitude - 1);
+    h->counts = xcalloc(h->n_counts, sizeof(int64_t));
+    h->min = INT64_MAX;
+    return h;
+}
+
+void hist_free(Histogram *h) {
+    require_not_null(h);
+    free(h->counts);
+    free(h);
+}
+
+void hist_reset(Histogram *h) {
+    require_not_null(h);
+    memset(h->counts, 0, h->n_counts * sizeof(int64_t));
+    h->count = 0;
+    h->min = INT64_MAX;
+    h->max = 0;
+    h->sum = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Recording
+
+// Adds to the sum of the values, which stays at INT64_MAX once it overflows.
+static void add_to_sum(Histogram *h, int64_t value, int64_t n) {
+    int64_t product;
+    if (__builtin_mul_overflow(value, n, &product) || __builtin_add_overflow(h->sum, product, &h->sum)) {
+        h->sum = INT64_MAX;
+    }
+}
+
+void hist_record_n(Histogram *h, int64_t value, int64_t n) {
+    require_not_null(h);
+    require("not negative", n >= 0);
+    if (value < 0) value = 0;
+    if (value > h->highest) value = h->highest;
+    h->counts[index_of(h, value)] += n;
+    h->count += n;
+    add_to_sum(h, value, n);
+    if (value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+}
+
+void hist_record(Histogram *h, int64_t value) {
+    hist_record_n(h, value, 1);
+}
+
+void hist_merge(Histogram *into, const Histogram *from) {
+    require_not_null(into);
+    require_not_null(from);
+    require("same configuration", into->highest == from->highest && into->digits == from->digits);
+    for (int i = 0; i < into->n_counts; i++) into->counts[i] += from->counts[i];
+    into->count += from->count;
+    add_to_sum(into, from->sum, 1);
+    if (from->min < into->min) into->min = from->min;
+    if (from->max > into->max) into->max = from->max;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Queries
+
+int64_t hist_percentile(const Histogram *h, double percent) {
+    require_not_null(h);
+    require("valid percentage", percent >= 0 && percent <= 100);
+    if (h->count == 0) return 0;
+    int64_t rank = (int64_t)(percent / 100 * h->count + 0.5);
+    if (rank < 1) rank = 1;
+    int64_t seen = 0;
+    for (int i = 0; i < h->n_counts; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            int64_t value = value_of(h, i);
+            value += width_of(h, value) - 1;
+            return (value < h->max) ? value : h->max;
+        }
+    }
+    return h->max;
+}
+
+int64_t hist_min(const Histogram *h) {
+    require_not_null(h);
+    return (h->count > 0) ? h->min : 0;
+}
+
+int64_t hist_max(const Histogram *h) {
+    require_not_null(h);
+    return h->max;
+}
+
+double hist_mean(const Histogram *h) {
+    require_not_null(h);
+    return (h->count > 0) ? (double)h->sum / h->count : 0;
+}
+
+void hist_print(FILE *f, const Histogram *h) {
+    require_not_null(f);
+    require_not_null(h);
+    fprintf(f, "count %lld  min %lld  mean %.1f  p50 %lld  p90 %lld  p99 %lld  p99.9 %lld  max %lld\n",
+            (long long)h->count, (long long)hist_min(h), hist_mean(h),
+            (long long)hist_percentile(h, 50), (long long)hist_percentile(h, 90),
+            (long long)hist_percentile(h, 99), (long long)hist_percentile(h, 99.9), (long long)hist_max(h));
+}
+
+void hist_print_json(FILE *f, const Histogram *h) {
+    require_not_null(f);
+    require_not_null(h);
+    fprintf(f, "{\"count\": %lld, \"sum\": %lld, \"mean\": %.1f, \"min\": %lld, \"p50\": %lld, "
+            "\"p90\": %lld, \"p99\": %lld, \"p999\": %lld, \"max\": %lld}",
+            (long long)h->count, (long long)h->sum, hist_mean(h), (long long)hist_min(h),
+            (long long)hist_percentile(h, 50), (long long)hist_percentile(h, 90),
+            (long long)hist_percentile(h, 99), (long long)hist_percentile(h, 99.9), (long long)hist_max(h));
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Encoding
+
+// The format is "HST1", then as variable-length numbers (7 bits per byte, least
+// significant first) the number of significant digits, the highest value, min, max,
+// and sum, then the counts up to the last nonzero one. A count c > 0 is written as
+// 2c, a run of k empty counts as 2k - 1.
+
+static Byte magic[4] = { 'H', 'S', 'T', '1' };
+
+static Byte *put_number(Byte *p, uint64_t x) {
+    while (x >= 0x80) {
+        *p++ = (Byte)(x | 0x80);
+        x >>= 7;
+    }
+    *p++ = (Byte)x;
+    return p;
+}
+
+static void corrupt_data(void) {
+    fprintf(stderr, "hist_decode: corrupt histogram data\n");
+    base_exit(EXIT_FAILURE);
+}
+
+static uint64_t get_number(const Byte **p, const Byte *end) {
+    uint64_t x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*p >= end) corrupt_data();
+        Byte b = *(*p)++;
+        x |= (uint64_t)(b & 0x7f) << shift;
+        if (b < 0x80) return x;
+    }
+    corrupt_data();
+    return 0;
+}
+
+Byte *hist_encode(const Histogram *h, size_t *n) {
+    require_not_null(h);
+    require_not_null(n);
+    int last = h->n_counts - 1;
+    while (last >= 0 && h->counts[last] == 0) last--;
+    // at most 10 bytes per number
+    Byte *data = xmalloc(sizeof(magic) + 10 * (5 + last + 1));
+    memcpy(data, magic, sizeof(magic));
+    Byte *p = data + sizeof(magic);
+    p = put_number(p, h->digits);
+    p = put_number(p, h->highest);
+    p = put_number(p, h->min);
+    p = put_number(p, h->max);
+    p = put_number(p, h->sum);
+    for (int i = 0; i <= last; ) {
+        if (h->counts[i] > 0) {
+            p = put_number(p, 2 * (uint64_t)h->counts[i]);
+            i++;
+        } else {
+            int k = 0;
+            while (h->counts[i] == 0) {
+                k++;
+                i++;
+            }
+            p = put_number(p, 2 * (uint64_t)k - 1);
+        }
+    }
+    *n = p - data;
+    return data;
+}
+
+Histogram *hist_decode(const Byte *data, size_t n) {
+    require_not_null(data);
+    const Byte *p = data;
+    const Byte *end = data + n;
+    if (n < sizeof(magic) || memcmp(data, magic, sizeof(magic)) != 0) corrupt_data();
+    p += sizeof(magic);
+    uint64_t digits = get_number(&p, end);
+    uint64_t highest = get_number(&p, end);
+    if (digits < 1 || digits > 5 || highest < 2 || highest > INT64_MAX) corrupt_data();
+    Histogram *h = hist_new(highest, digits);
+    h->min = get_number(&p, end);
+    h->max = get_number(&p, end);
+    h->sum = get_number(&p, end);
+    int i = 0;
+    while (p < end) {
+        uint64_t x = get_number(&p, end);
+        if (x % 2 == 0) {
+            if (i >= h->n_counts) corrupt_data();
+            h->counts[i++] = x / 2;
+            h->count += x / 2;
+        } else {
+            if (x / 2 + 1 > (uint64_t)(h->n_counts - i)) corrupt_data();
+            i += x / 2 + 1;
+        }
+    }
+    return h;
+}
@@ -0,0 +1,155 @@
+/** @file
+Histograms of values such as latencies, with a given number of significant digits (in the style of HdrHistogram). Recording a value takes constant time and does not allocate memory. Percentiles, the minimum, the maximum, and the mean can be queried at any time. Histograms with the same configuration can be merged, e.g., one per thread into a total, and written into a compact byte format.
+
+Example: Record the durations of calls on two threads, then print percentiles.
+@code{.c}
+Histogram *a = hist_new(HIST_HOUR_NS, 3); // up to one hour in ns, 3 significant digits
+Histogram *b = hist_new(HIST_HOUR_NS, 3);
+// in thread 1:
+int64_t start = time_ns();
+work();
+hist_record(a, time_ns_since(start));
+// in thread 2, likewise with b, then after joining:
+hist_merge(a, b);
+printf("median %lld ns, 99th percentile %lld ns\n", (long long)hist_percentile(a, 50), (long long)hist_percentile(a, 99));
+hist_free(a);
+hist_free(b);
+@endcode
+
+A value is counted in a bucket of values that are equal in their significant digits. With 3 significant digits, a bucket around 1000000 is 512 wide, so percentiles are within 0.1% of the exact value. The buckets of each power of two have equal widths, so the memory of a histogram is fixed by its highest value and its number of significant digits: about 270 kilobytes for one hour in nanoseconds with 3 significant digits. The minimum, maximum, and mean are exact, unless the sum of the values exceeds 2^63 - 1.
+
+A histogram is not synchronized. Use one histogram per thread and merge them.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __HISTOGRAM_H__
+#define __HISTOGRAM_H__
+
+#include "base.h"
+
+/**
+One hour in nanoseconds, a typical highest value for latencies.
+*/
+#define HIST_HOUR_NS (3600LL * 1000 * 1000 * 1000)
+
+/**
+A histogram of the values from 0 to a highest value.
+@see hist_new, hist_record, hist_percentile, hist_merge, hist_free
+*/
+typedef struct Histogram {
+    int64_t highest; ///< the highest value that can be recorded, larger values are recorded as this value
+    int digits; ///< the number of significant digits
+    int sub_bucket_magnitude; ///< log2 of the number of values per bucket
+    int n_counts; ///< the number of counts
+    int64_t count; ///< the number of recorded values
+    int64_t min; ///< the smallest recorded value, INT64_MAX if there are none
+    int64_t max; ///< the largest recorded value, 0 if there are none
+    int64_t sum; ///< the sum of the recorded values, INT64_MAX if it overflows
+    int64_t *counts; ///< the number of values per bucket
+} Histogram;
+
+/**
+Creates an empty histogram.
+@param[in] highest the highest value to be recorded, at least 2, e.g., @ref HIST_HOUR_NS
+@param[in] digits the number of significant digits, from 1 to 5
+@return the histogram, free it with @ref hist_free
+*/
+Histogram *hist_new(int64_t highest, int digits);
+
+/**
+Frees a histogram.
+@param[in,out] h the histogram
+*/
+void hist_free(Histogram *h);
+
+/**
+Removes all values from a histogram.
+@param[in,out] h the histogram
+*/
+void hist_reset(Histogram *h);
+
+/**
+Records a value. Negative values are recorded as 0, values above the highest value as the highest value.
+@param[in,out] h the histogram
+@param[in] value the value
+*/
+void hist_record(Histogram *h, int64_t value);
+
+/**
+Records a value several times.
+@param[in,out] h the histogram
+@param[in] value the value
+@param[in] n the number of times, not negative
+*/
+void hist_record_n(Histogram *h, int64_t value, int64_t n);
+
+/**
+Adds the values of a histogram to another. Both must have the same highest value and number of significant digits.
+@param[in,out] into the histogram to add to
+@param[in] from the histogram to add
+*/
+void hist_merge(Histogram *into, const Histogram *from);
+
+/**
+Gets the value below which the given percentage of the recorded values are. The value is the highest value of its bucket, but not larger than the maximum.
+@param[in] h the histogram
+@param[in] percent the percentage, from 0 to 100, e.g., 50 for the median or 99.9
+@return the value, 0 if there are no values
+*/
+int64_t hist_percentile(const Histogram *h, double percent);
+
+/**
+Gets the smallest recorded value.
+@param[in] h the histogram
+@return the smallest value, 0 if there are no values
+*/
+int64_t hist_min(const Histogram *h);
+
+/**
+Gets the largest recorded value.
+@param[in] h the histogram
+@return the largest value, 0 if there are no values
+*/
+int64_t hist_max(const Histogram *h);
+
+/**
+Gets the mean of the recorded values.
+@param[in] h the histogram
+@return the mean, 0 if there are no values
+*/
+double hist_mean(const Histogram *h);
+
+/**
+Prints the number of values, the minimum, mean, maximum, and the 50th, 90th, 99th, and 99.9th percentiles in a line.
+@param[in] f the stream to print to, e.g., @c stdout
+@param[in] h the histogram
+*/
+void hist_print(FILE *f, const Histogram *h);
+
+/**
+Prints the number of values, the sum, mean, minimum, maximum, and the 50th, 90th, 99th, and 99.9th percentiles as a JSON object, without a line break.
+@param[in] f the stream to print to, e.g., @c stdout
+@param[in] h the histogram
+*/
+void hist_print_json(FILE *f, const Histogram *h);
+
+/**
+Encodes a histogram into bytes. Runs of empty buckets take one or two bytes, typical counts one to three bytes.
+@param[in] h the histogram
+@param[out] n receives the number of bytes
+@return the bytes, free them with @c free
+*/
+Byte *hist_encode(const Histogram *h, size_t *n);
+
+/**
+Decodes a histogram that was encoded with @ref hist_encode. Exits the program if the data is corrupt.
+@param[in] data the bytes
+@param[in] n the number of bytes
+@return the histogram, free it with @ref hist_free
+*/
+Histogram *hist_decode(const Byte *data, size_t n);
+
+#endif
@@ -0,0 +1,223 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "lineindex.h"
+#include "stream.h"
+
+// Header of an index file, followed by n_lines + 1 offsets in native byte order.
+typedef struct IndexHeader {
+    char magic[8];
+    uint64_t text_size; // size of the text when the index was built
+    int64_t text_mtime_sec; // modification time of the text when the index was built
+    int64_t text_mtime_nsec;
+    uint64_t n_lines;
+} IndexHeader;
+
+#define INDEX_MAGIC "LINEIDX1"
+#define INDEX_EXTENSION ".lidx"
+
+#ifdef __SSE2__
+// Sets one bit for each line break in the 64 bytes at p.
+static inline uint64_t line_break_mask(const Byte *p) {
+    __m128i nl = _mm_set1_epi8('\n');
+    uint64_t m = 0;
+    for (int k = 0; k < 4; k++) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p + 16 * k));
+        m |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(x, nl)) << (16 * k);
+    }
+    return m;
+}
+#endif
+
+// Finds the start of every line. The array starts with 0 and ends with size.
+static void find_line_starts(LineIndex *x) {
+    const Byte *data = x->data;
+    size_t size = x->size;
+    size_t capacity = size / 32 + 64;
+    size_t *starts = xmalloc(capacity * sizeof(size_t));
+    size_t n = 0;
+    starts[n++] = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 64 <= size; i += 64) {
+        if (n + 65 > capacity) {
+            capacity *= 2;
+            starts = xrealloc(starts, capacity * sizeof(size_t));
+        }
+        uint64_t m = line_break_mask(data + i);
+        while (m != 0) {
+            starts[n++] = i + __builtin_ctzll(m) + 1;
+            m &= m - 1;
+        }
+    }
+#endif
+    for (; i < size; i++) {
+        if (data[i] == '\n') {
+            if (n + 2 > capacity) {
+                capacity *= 2;
+                starts = xrealloc(starts, capacity * sizeof(size_t));
+            }
+            starts[n++] = i + 1;
+        }
+    }
+    // a last line without line break ends at the end of the text
+    if (starts[n - 1] != size) starts[n++] = size;
+    x->allocated_starts = xrealloc(starts, n * sizeof(size_t));
+    x->starts = x->allocated_starts;
+    x->n_lines = n - 1;
+}
+
+LineIndex *li_of_buffer(const Byte *data, size_t size) {
+    require("data not null", data != NULL || size == 0);
+    LineIndex *x = xcalloc(1, sizeof(LineIndex));
+    x->data = data;
+    x->size = size;
+    find_line_starts(x);
+    return x;
+}
+
+// Maps the index file if it belongs to the text, otherwise returns false.
+static bool load_index(LineIndex *x, String index_name, struct stat *text_stat) {
+    struct stat st;
+    if (stat(index_name, &st) != 0 || st.st_size < (off_t)sizeof(IndexHeader)) return false;
+    MappedFile m = map_file(index_name, ADVICE_RANDOM);
+    IndexHeader h;
+    memcpy(&h, m.data, sizeof(h));
+    if (memcmp(h.magic, INDEX_MAGIC, sizeof(h.magic)) != 0
+            || h.text_size != (uint64_t)text_stat->st_size
+            || h.text_mtime_sec != text_stat->st_mtim.tv_sec
+            || h.text_mtime_nsec != text_stat->st_mtim.tv_nsec
+            || m.size != sizeof(h) + (h.n_lines + 1) * sizeof(size_t)) {
+        unmap_file(&m);
+        return false;
+    }
+    x->index = m;
+    x->starts = (const size_t*)(m.data + sizeof(h));
+    x->n_lines = h.n_lines;
+    return true;
+}
+
+// Writes all n bytes, returns false on error.
+static bool write_fully(int fd, const Byte *p, size_t n) {
+    while (n > 0) {
+        ssize_t k = write(fd, p, n < (1 << 30) ? n : (1 << 30));
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k;
+        n -= k;
+        base_metric_add(BASE_METRIC_BYTES_WRITTEN, k);
+    }
+    return true;
+}
+
+// Saves the index if possible, it only speeds up later runs. Writes to a temporary
+// file that replaces the index file when complete, so that a concurrent reader
+// never maps a partial index. Leaves no file behind if the directory is not
+// writable or the disk is full.
+static void save_index(LineIndex *x, String index_name, struct stat *text_stat) {
+    IndexHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, INDEX_MAGIC, sizeof(h.magic));
+    h.text_size = text_stat->st_size;
+    h.text_mtime_sec = text_stat->st_mtim.tv_sec;
+    h.text_mtime_nsec = text_stat->st_mtim.tv_nsec;
+    h.n_lines = x->n_lines;
+    int n = strlen(index_name) + 8;
+    char *temp_name = xmalloc(n);
+    snprintf(temp_name, n, "%s.XXXXXX", index_name);
+    int fd = mkstemp(temp_name);
+    if (fd >= 0) {
+        // whoever may read the text may read its index
+        bool ok = fchmod(fd, text_stat->st_mode & 0666) == 0
+                && write_fully(fd, (const Byte*)&h, sizeof(h))
+                && write_fully(fd, (const Byte*)x->starts, (x->n_lines + 1) * sizeof(size_t));
+        ok = close(fd) == 0 && ok;
+        if (!ok || rename(temp_name, index_name) != 0) unlink(temp_name);
+    }
+    free(temp_name);
+}
+
+LineIndex *li_of_file(String name, bool persist) {
+    require_not_null(name);
+    LineIndex *x = xcalloc(1, sizeof(LineIndex));
+    x->text = map_file(name, ADVICE_NORMAL);
+    x->data = x->text.data;
+    x->size = x->text.size;
+    if (!persist) {
+        find_line_starts(x);
+        return x;
+    }
+
+    struct stat st;
+    if (stat(name, &st) != 0) {
+        fprintf(stderr, "li_of_file: Cannot access %s\n", name);
+        base_exit(EXIT_FAILURE);
+    }
+    int n = strlen(name) + strlen(INDEX_EXTENSION) + 1;
+    char *index_name = xmalloc(n);
+    snprintf(index_name, n, "%s%s", name, INDEX_EXTENSION);
+    if (!load_index(x, index_name, &st)) {
+        advise_mapped_file(&x->text, ADVICE_SEQUENTIAL);
+        find_line_starts(x);
+        advise_mapped_file(&x->text, ADVICE_NORMAL);
+        save_index(x, index_name, &st);
+    }
+    free(index_name);
+    return x;
+}
+
+StringView li_line(LineIndex *x, size_t k) {
+    require_not_null(x);
+    require("valid line number", k < x->n_lines);
+    size_t start = x->starts[k];
+    size_t end = x->starts[k + 1];
+    if (end > start && x->data[end - 1] == '\n') end--;
+    if (end > start && x->data[end - 1] == '\r') end--;
+    return make_string_view((const char*)x->data + start, end - start);
+}
+
+StringView li_lines(LineIndex *x, size_t first, size_t count) {
+    require_not_null(x);
+    require("valid line range", first <= x->n_lines && count <= x->n_lines - first);
+    size_t start = x->starts[first];
+    size_t end = x->starts[first + count];
+    if (end > start && x->data[end - 1] == '\n') end--;
+    if (end > start && x->data[end - 1] == '\r') end--;
+    require("range fits in a view", end - start <= INT_MAX);
+    return make_string_view((const char*)x->data + start, end - start);
+}
+
+size_t li_line_of_offset(LineIndex *x, size_t offset) {
+    require_not_null(x);
+    require("valid offset", offset < x->size);
+    // find the last line that starts at or before offset
+    size_t lo = 0, hi = x->n_lines;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (x->starts[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void li_free(LineIndex *x) {
+    require_not_null(x);
+    if (x->allocated_starts != NULL) free(x->allocated_starts);
+    if (x->index.data != NULL) unmap_file(&x->index);
+    if (x->text.data != NULL) unmap_file(&x->text);
+    free(x);
+}
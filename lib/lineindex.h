@@ -0,0 +1,92 @@
+/** @file
+Line indices for random access to the lines of a text. The index records the start offset of every line in one pass over the text. Afterwards, line k is found in constant time, without scanning the text again.
+
+Example: Print line 42 (counting from 0) of a file.
+@code{.c}
+LineIndex *x = li_of_file("example.txt", false);
+if (x->n_lines > 42) {
+    StringView line = li_line(x, 42);
+    printf("%.*s\n", line.length, line.s);
+}
+li_free(x);
+@endcode
+
+Building the index of a large file takes a pass over the whole file. With @c persist set to @c true, @ref li_of_file saves the index next to the file (with the additional extension @c ".lidx") and maps it into memory on the next run, as long as the file has not changed. Saving is best-effort: if the index file cannot be written, the index is still returned.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __LINEINDEX_H__
+#define __LINEINDEX_H__
+
+#include "base.h"
+#include "mapfile.h"
+
+/**
+The start offsets of the lines of a text. Line @c k consists of the bytes from @c starts[k] (inclusive) to @c starts[k+1] (exclusive), including its line break. A last line without a line break counts as a line.
+@see li_of_buffer, li_of_file, li_line, li_lines, li_free
+*/
+typedef struct LineIndex {
+    const Byte *data; ///< the indexed text (not zero-terminated)
+    size_t size; ///< number of bytes of the text
+    size_t n_lines; ///< number of lines
+    const size_t *starts; ///< n_lines + 1 offsets, @c starts[n_lines] is @c size
+    size_t *allocated_starts; ///< the offsets if built in memory, otherwise NULL
+    MappedFile text; ///< the mapped text if created with @ref li_of_file
+    MappedFile index; ///< the mapped index if loaded from an index file
+} LineIndex;
+
+/**
+Indexes the lines of a buffer. The buffer has to stay valid until the index is freed.
+@param[in] data the text
+@param[in] size number of bytes of the text
+@return the line index, free it with @ref li_free
+*/
+LineIndex *li_of_buffer(const Byte *data, size_t size);
+
+/**
+Maps the file with the given name into memory and indexes its lines. Exits the program if the file cannot be opened.
+@param[in] name file name (including path)
+@param[in] persist if @c true, loads the index from the index file @c name.lidx if it is up to date, otherwise builds the index and saves it to that file if possible
+@return the line index, free it with @ref li_free
+*/
+LineIndex *li_of_file(String name, bool persist);
+
+/**
+Gets a line. The line break (@c "\n" or @c "\r\n") is not part of the line.
+@param[in] x line index
+@param[in] k line number, starting at 0
+@return a view of the line in the text
+@pre "valid line number", k < x->n_lines
+*/
+StringView li_line(LineIndex *x, size_t k);
+
+/**
+Gets consecutive lines. The line breaks between the lines are part of the view, the line break of the last line is not.
+@param[in] x line index
+@param[in] first number of the first line, starting at 0
+@param[in] count number of lines
+@return a view of the lines in the text
+@pre "valid line range", first + count <= x->n_lines
+@pre "range fits in a view", the lines are less than 2 GB in total
+*/
+StringView li_lines(LineIndex *x, size_t first, size_t count);
+
+/**
+Finds the line that contains a byte of the text, by binary search.
+@param[in] x line index
+@param[in] offset position in the text
+@return the line number
+@pre "valid offset", offset < x->size
+*/
+size_t li_line_of_offset(LineIndex *x, size_t offset);
+
+/**
+Frees the line index. Unmaps the text if the index was created with @ref li_of_file.
+@param[in] x line index
+*/
+void li_free(LineIndex *x);
+
+#endif
@@ -0,0 +1,71 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapfile.h"
+
+// data of mapped files of size 0, since mmap cannot map empty files
+static const Byte empty_data[1] = { 0 };
+
+static int madvise_advice(MapAdvice advice) {
+    switch (advice) {
+        case ADVICE_SEQUENTIAL: return MADV_SEQUENTIAL;
+        case ADVICE_RANDOM: return MADV_RANDOM;
+        case ADVICE_WILLNEED: return MADV_WILLNEED;
+        default: return MADV_NORMAL;
+    }
+}
+
+MappedFile base_map_file(const char *file, const char *function, int line, String name, MapAdvice advice) {
+    require_not_null(name);
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "map_file: Cannot open %s\n", name);
+        base_exit(EXIT_FAILURE);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "map_file: %s is not a regular file\n", name);
+        base_exit(EXIT_FAILURE);
+    }
+
+    MappedFile m = { empty_data, 0 };
+    if (st.st_size > 0) {
+        Byte *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            fprintf(stderr, "map_file: Cannot map %s\n", name);
+            base_exit(EXIT_FAILURE);
+        }
+        madvise(p, st.st_size, madvise_advice(advice));
+        base_track(file, function, line, p, st.st_size);
+        m.data = p;
+        m.size = st.st_size;
+    }
+    close(fd); // the mapping stays valid
+    return m;
+}
+
+void advise_mapped_file(MappedFile *m, MapAdvice advice) {
+    require_not_null(m);
+    if (m->size > 0) {
+        madvise((void*)m->data, m->size, madvise_advice(advice));
+    }
+}
+
+void unmap_file(MappedFile *m) {
+    require_not_null(m);
+    if (m->size > 0) {
+        if (!base_untrack((Any)m->data)) {
+            fprintf(stderr, "unmap_file: trying to unmap unknown pointer %p\n", (Any)m->data);
+        }
+        munmap((void*)m->data, m->size);
+    }
+    m->data = NULL;
+    m->size = 0;
+}
@@ -0,0 +1,81 @@
+/** @file
+Memory-mapped files. A mapped file is not read into a newly allocated buffer, like with @ref s_read_file. Instead, the operating system makes the contents of the file directly accessible in memory and loads pages of the file when they are first accessed. This avoids copying the data and does not need memory beyond the page cache.
+
+Example: Count the lines of a file.
+@code{.c}
+MappedFile m = map_file("example.txt", ADVICE_SEQUENTIAL);
+int lines = 0;
+for (size_t i = 0; i < m.size; i++) {
+    if (m.data[i] == '\n') lines++;
+}
+unmap_file(&m);
+printiln(lines);
+@endcode
+
+The contents are read-only and not zero-terminated. Mapped files that are not unmapped are reported as memory leaks (see @ref report_memory_leaks).
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __MAPFILE_H__
+#define __MAPFILE_H__
+
+#include "base.h"
+
+/**
+Tells the operating system how the contents of a mapped file are going to be accessed, such that it can read ahead or drop pages accordingly.
+@see map_file, advise_mapped_file
+*/
+typedef enum MapAdvice {
+    ADVICE_NORMAL, ///< no particular access pattern
+    ADVICE_SEQUENTIAL, ///< sequential access from start to end, read ahead aggressively
+    ADVICE_RANDOM, ///< random access, do not read ahead
+    ADVICE_WILLNEED ///< the whole file will be needed soon, start reading it now
+} MapAdvice;
+
+/**
+A read-only memory-mapped file.
+@see map_file, unmap_file
+*/
+typedef struct MappedFile {
+    const Byte *data; ///< the contents of the file (not zero-terminated)
+    size_t size; ///< the size of the file in bytes
+} MappedFile;
+
+/**
+Maps a file into memory. Exits with an error message on failure.
+@param[in] file file name of source code
+@param[in] function function name of source code
+@param[in] line line number in source code
+@param[in] name file name (including path)
+@param[in] advice expected access pattern
+@return the mapped file
+@see map_file
+@private
+*/
+MappedFile base_map_file(const char *file, const char *function, int line, String name, MapAdvice advice);
+
+/**
+Maps the file with the given name into memory for reading. The program exits if the file cannot be opened or mapped. An empty file results in a mapped file of size 0.
+@param[in] name (String) file name (including path)
+@param[in] advice (MapAdvice) expected access pattern
+@return (MappedFile) the mapped file, unmap it with @ref unmap_file
+*/
+#define map_file(name, advice) base_map_file(__FILE__, __func__, __LINE__, name, advice)
+
+/**
+Changes the expected access pattern of a mapped file.
+@param[in] m mapped file
+@param[in] advice expected access pattern
+*/
+void advise_mapped_file(MappedFile *m, MapAdvice advice);
+
+/**
+Unmaps a mapped file. Afterwards @c m->data is @c NULL and @c m->size is 0.
+@param[in,out] m mapped file
+*/
+void unmap_file(MappedFile *m);
+
+#endif
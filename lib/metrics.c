@@ -0,0 +1,350 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <pthread.h>
+#include "metrics.h"
+#undef free // use the 'real' free for the values of the threads
+
+// Number of significant digits of the histograms.
+#define METRICS_HISTOGRAM_DIGITS 2
+
+// The metric values of a thread. Only the thread itself writes to its values. The
+// value of a histogram is a pointer to the thread's Histogram, NULL before the first
+// recorded value.
+typedef struct MetricShard {
+    struct MetricShard *next;
+    int n_cells; // the number of values, grows when metrics are registered
+    int64_t *cells;
+} MetricShard;
+
+__thread int64_t *base_metric_cells = NULL;
+static __thread MetricShard *thread_shard = NULL;
+static __thread int thread_n_cells = 0;
+
+// the shards of the running threads
+static MetricShard *shards = NULL;
+// the values of the threads that have ended, added up
+static int64_t retired[METRICS_MAX];
+static pthread_mutex_t shards_mutex = PTHREAD_MUTEX_INITIALIZER;
+// frees the shard of a thread when it ends
+static pthread_key_t shard_key;
+static pthread_once_t shard_key_once = PTHREAD_ONCE_INIT;
+
+// the library metrics occupy the first cells
+static Metric metrics[METRICS_MAX] = {
+    { "contract_checks", METRIC_COUNTER, BASE_METRIC_CONTRACT_CHECKS, 0 },
+    { "memory.allocations", METRIC_COUNTER, BASE_METRIC_ALLOCATIONS, 0 },
+    { "memory.allocated_bytes", METRIC_COUNTER, BASE_METRIC_ALLOCATED_BYTES, 0 },
+    { "memory.frees", METRIC_COUNTER, BASE_METRIC_FREES, 0 },
+    { "file.bytes_read", METRIC_COUNTER, BASE_METRIC_BYTES_READ, 0 },
+    { "file.bytes_written", METRIC_COUNTER, BASE_METRIC_BYTES_WRITTEN, 0 },
+};
+static int n_metrics = BASE_METRICS;
+static int n_cells = BASE_METRICS;
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static Histogram *histogram_of(int64_t cell) {
+    return (Histogram*)(intptr_t)cell;
+}
+
+// Frees a histogram of a thread. Not hist_free, because the histogram is not in the
+// records of allocated memory.
+static void free_histogram(Histogram *h) {
+    free(h->counts);
+    free(h);
+}
+
+// Adds the values of the shard of an ending thread to the retired values, then
+// frees the shard. Called by the thread itself.
+static void retire_shard(Any arg) {
+    MetricShard *s = arg;
+    pthread_mutex_lock(&metrics_mutex);
+    pthread_mutex_lock(&shards_mutex);
+    for (int i = 0; i < n_metrics; i++) {
+        Metric *m = &metrics[i];
+        if (m->cell >= s->n_cells) continue;
+        if (m->kind == METRIC_COUNTER) {
+            retired[m->cell] += s->cells[m->cell];
+        } else if (m->kind == METRIC_HISTOGRAM && s->cells[m->cell] != 0) {
+            Histogram *h = histogram_of(s->cells[m->cell]);
+            if (retired[m->cell] == 0) {
+                retired[m->cell] = (intptr_t)h;
+            } else {
+                hist_merge(histogram_of(retired[m->cell]), h);
+                free_histogram(h);
+                retired[BASE_METRIC_FREES] += 2;
+            }
+        }
+    }
+    MetricShard **p = &shards;
+    while (*p != s) p = &(*p)->next;
+    *p = s->next;
+    pthread_mutex_unlock(&shards_mutex);
+    pthread_mutex_unlock(&metrics_mutex);
+    // later updates of this thread, e.g., in other destructors, allocate a new shard
+    base_metric_cells = NULL;
+    thread_shard = NULL;
+    thread_n_cells = 0;
+    free(s->cells);
+    free(s);
+}
+
+static void create_shard_key(void) {
+    if (pthread_key_create(&shard_key, retire_shard) != 0) {
+        fprintf(stderr, "base_metric_thread_cells: Cannot create thread key.\n");
+        base_exit(EXIT_FAILURE);
+    }
+}
+
+int64_t *base_metric_thread_cells(void) {
+    pthread_once(&shard_key_once, create_shard_key);
+    MetricShard *s = thread_shard;
+    int n = __atomic_load_n(&n_cells, __ATOMIC_RELAXED);
+    // not xcalloc: allocations update metrics themselves
+    int64_t *cells = calloc(n, sizeof(int64_t));
+    if (s == NULL) s = calloc(1, sizeof(MetricShard));
+    if (cells == NULL || s == NULL) {
+        fprintf(stderr, "%s: Cannot allocate metrics.\n", (String)__func__);
+        base_exit(EXIT_FAILURE);
+    }
+    pthread_mutex_lock(&shards_mutex);
+    int64_t *old = s->cells;
+    if (old == NULL) {
+        s->next = shards;
+        shards = s;
+    } else {
+        memcpy(cells, old, s->n_cells * sizeof(int64_t));
+    }
+    s->cells = cells;
+    s->n_cells = n;
+    pthread_mutex_unlock(&shards_mutex);
+    free(old);
+    if (thread_shard == NULL) {
+        thread_shard = s;
+        pthread_setspecific(shard_key, s);
+    }
+    base_metric_cells = cells;
+    thread_n_cells = n;
+    return cells;
+}
+
+static int64_t load(int64_t *p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static void store(int64_t *p, int64_t value) {
+    __atomic_store_n(p, value, __ATOMIC_RELAXED);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Registration
+
+static Metric *metric_of_kind(const char *function, String name, MetricKind kind) {
+    require_not_null(name);
+    pthread_mutex_lock(&metrics_mutex);
+    Metric *m = NULL;
+    for (int i = 0; i < n_metrics; i++) {
+        if (strcmp(metrics[i].name, name) == 0) {
+            m = &metrics[i];
+            break;
+        }
+    }
+    if (m != NULL && m->kind != kind) {
+        fprintf(stderr, "%s: %s is a metric of another kind\n", function, name);
+        base_exit(EXIT_FAILURE);
+    }
+    if (m == NULL) {
+        if (n_metrics >= METRICS_MAX) {
+            fprintf(stderr, "%s: Too many metrics, cannot register %s\n", function, name);
+            base_exit(EXIT_FAILURE);
+        }
+        m = &metrics[n_metrics++];
+        m->name = name;
+        m->kind = kind;
+        m->cell = n_cells;
+        m->gauge = 0;
+        if (kind != METRIC_GAUGE) __atomic_store_n(&n_cells, n_cells + 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&metrics_mutex);
+    return m;
+}
+
+Metric *metric_counter(String name) {
+    return metric_of_kind(__func__, name, METRIC_COUNTER);
+}
+
+Metric *metric_gauge(String name) {
+    return metric_of_kind(__func__, name, METRIC_GAUGE);
+}
+
+Metric *metric_histogram(String name) {
+    return metric_of_kind(__func__, name, METRIC_HISTOGRAM);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Updates
+
+void metric_add(Metric *m, int64_t n) {
+    if (m->kind == METRIC_GAUGE) {
+        __atomic_fetch_add(&m->gauge, n, __ATOMIC_RELAXED);
+    } else {
+        // enlarge the values of the thread if the counter was registered since
+        int64_t *c = (m->cell < thread_n_cells) ? base_metric_cells : base_metric_thread_cells();
+        store(&c[m->cell], c[m->cell] + n);
+    }
+}
+
+void metric_set(Metric *m, int64_t value) {
+    store(&m->gauge, value);
+}
+
+void metric_record(Metric *m, int64_t value) {
+    int64_t *c = (m->cell < thread_n_cells) ? base_metric_cells : base_metric_thread_cells();
+    Histogram *h = histogram_of(c[m->cell]);
+    if (h == NULL) {
+        h = hist_new(INT64_MAX, METRICS_HISTOGRAM_DIGITS);
+        // freed when the thread ends or kept until the program exits, not a leak
+        base_untrack(h->counts);
+        base_untrack(h);
+        store(&c[m->cell], (intptr_t)h);
+    }
+    hist_record(h, value);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Reading
+
+int64_t metric_value(Metric *m) {
+    require_not_null(m);
+    require("counter or gauge", m->kind != METRIC_HISTOGRAM);
+    if (m->kind == METRIC_GAUGE) return load(&m->gauge);
+    pthread_mutex_lock(&shards_mutex);
+    int64_t value = retired[m->cell];
+    for (MetricShard *s = shards; s != NULL; s = s->next) {
+        if (m->cell < s->n_cells) value += load(&s->cells[m->cell]);
+    }
+    pthread_mutex_unlock(&shards_mutex);
+    return value;
+}
+
+Histogram *metric_snapshot(Metric *m) {
+    require_not_null(m);
+    require("histogram", m->kind == METRIC_HISTOGRAM);
+    Histogram *h = hist_new(INT64_MAX, METRICS_HISTOGRAM_DIGITS);
+    pthread_mutex_lock(&shards_mutex);
+    if (retired[m->cell] != 0) hist_merge(h, histogram_of(retired[m->cell]));
+    for (MetricShard *s = shards; s != NULL; s = s->next) {
+        if (m->cell < s->n_cells && load(&s->cells[m->cell]) != 0) {
+            hist_merge(h, histogram_of(load(&s->cells[m->cell])));
+        }
+    }
+    pthread_mutex_unlock(&shards_mutex);
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Output
+
+static int compare_metrics(ConstAny a, ConstAny b) {
+    const Metric *x = *(Metric *const*)a;
+    const Metric *y = *(Metric *const*)b;
+    if (x->kind != y->kind) return x->kind - y->kind;
+    return strcmp(x->name, y->name);
+}
+
+static void print_json_string(FILE *f, String s) {
+    fputc('"', f);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((Byte)*s < ' ') fprintf(f, "\\u%04x", *s);
+        else fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void print_text(FILE *f, Metric **sorted, int n) {
+    for (int i = 0; i < n; i++) {
+        Metric *m = sorted[i];
+        if (m->kind == METRIC_HISTOGRAM) {
+            Histogram *h = metric_snapshot(m);
+            fprintf(f, "%-9s %-30s ", "histogram", m->name);
+            hist_print(f, h);
+            hist_free(h);
+        } else {
+            fprintf(f, "%-9s %-30s %lld\n",
+                    m->kind == METRIC_COUNTER ? "counter" : "gauge", m->name, (long long)metric_value(m));
+        }
+    }
+}
+
+static void print_json(FILE *f, Metric **sorted, int n) {
+    String sections[] = { "counters", "gauges", "histograms" };
+    fprintf(f, "{");
+    for (MetricKind kind = METRIC_COUNTER; kind <= METRIC_HISTOGRAM; kind++) {
+        fprintf(f, "%s\n  \"%s\": {", kind == METRIC_COUNTER ? "" : ",", sections[kind]);
+        String separator = "\n    ";
+        for (int i = 0; i < n; i++) {
+            Metric *m = sorted[i];
+            if (m->kind != kind) continue;
+            fprintf(f, "%s", separator);
+            separator = ",\n    ";
+            print_json_string(f, m->name);
+            if (kind == METRIC_HISTOGRAM) {
+                Histogram *h = metric_snapshot(m);
+                fprintf(f, ": ");
+                hist_print_json(f, h);
+                hist_free(h);
+            } else {
+                fprintf(f, ": %lld", (long long)metric_value(m));
+            }
+        }
+        fprintf(f, "\n  }");
+    }
+    fprintf(f, "\n}\n");
+}
+
+void metrics_print(FILE *f, MetricsFormat format) {
+    require_not_null(f);
+    Metric *sorted[METRICS_MAX];
+    pthread_mutex_lock(&metrics_mutex);
+    int n = n_metrics;
+    for (int i = 0; i < n; i++) sorted[i] = &metrics[i];
+    pthread_mutex_unlock(&metrics_mutex);
+    qsort(sorted, n, sizeof(Metric*), compare_metrics);
+    if (format == METRICS_JSON) print_json(f, sorted, n);
+    else print_text(f, sorted, n);
+}
+
+static String exit_file = NULL;
+static MetricsFormat exit_format = METRICS_TEXT;
+static bool print_at_exit_registered = false;
+
+static void print_at_exit(void) {
+    if (exit_file == NULL) {
+        metrics_print(stderr, exit_format);
+        return;
+    }
+    FILE *f = fopen(exit_file, "w");
+    if (f == NULL) {
+        fprintf(stderr, "metrics_print_at_exit: Cannot open %s\n", exit_file);
+        return;
+    }
+    metrics_print(f, exit_format);
+    if (fclose(f) != 0) {
+        fprintf(stderr, "metrics_print_at_exit: Cannot write %s\n", exit_file);
+    }
+}
+
+void metrics_print_at_exit(String file, MetricsFormat format) {
+    pthread_mutex_lock(&metrics_mutex);
+    exit_file = file;
+    exit_format = format;
+    if (!print_at_exit_registered) {
+        atexit(print_at_exit);
+        print_at_exit_registered = true;
+    }
+    pthread_mutex_unlock(&metrics_mutex);
+}
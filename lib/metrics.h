@@ -0,0 +1,134 @@
+/** @file
+Runtime metrics: named counters, gauges, and histograms of values such as latencies. A counter counts events, e.g., requests served. A gauge holds a current value, e.g., the length of a queue. A histogram records the distribution of values, e.g., the durations of requests in nanoseconds, and reports percentiles.
+
+Example: Count requests and record their latencies, then print all metrics.
+@code{.c}
+Metric *requests = metric_counter("requests");
+Metric *latency = metric_histogram("request_ns");
+for (int i = 0; i < 1000; i++) {
+    int64_t start = time_ns();
+    serve_request();
+    metric_add(requests, 1);
+    metric_record(latency, time_ns_since(start));
+}
+metrics_print(stdout, METRICS_TEXT);
+@endcode
+
+Each thread updates its own copy of the counters and histograms, without locks or atomic read-modify-write instructions. The copies are added up when the metrics are reported. When a thread ends, its copy is added to a total and freed. The library itself counts executed contract checks (require and ensure, except those of the inline functions of base.h), memory allocations, and bytes read and written by its file functions.
+
+Histograms are @ref Histogram "Histograms" with 2 significant digits, so a percentile is within 1% of the exact value. Each thread that records values in a histogram has its own Histogram of about 57 kilobytes. Values range from 0 to 2^63 - 1, negative values are recorded as 0. A snapshot taken while other threads record may miss their latest values.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include "base.h"
+#include "histogram.h"
+
+/**
+Maximum number of metrics, including those of the library.
+*/
+#define METRICS_MAX 256
+
+/**
+The kinds of metrics.
+*/
+typedef enum MetricKind {
+    METRIC_COUNTER, ///< a sum of increments, e.g., the number of events
+    METRIC_GAUGE, ///< a current value
+    METRIC_HISTOGRAM ///< a distribution of values
+} MetricKind;
+
+/**
+A registered metric. Obtained from @ref metric_counter, @ref metric_gauge, or @ref metric_histogram, and valid until the program exits.
+*/
+typedef struct Metric {
+    String name; ///< the name of the metric
+    MetricKind kind; ///< the kind of the metric
+    int cell; ///< the index of the value of the metric in the values of each thread
+    int64_t gauge; ///< the value, if the metric is a gauge
+} Metric;
+
+/**
+Output formats of the metrics.
+*/
+typedef enum MetricsFormat {
+    METRICS_TEXT, ///< one line per metric
+    METRICS_JSON ///< a JSON object with counters, gauges, and histograms
+} MetricsFormat;
+
+/**
+Gets the counter of the given name. Registers it on the first call. Exits the program if there is a metric of another kind with this name or if @ref METRICS_MAX metrics are registered.
+@param[in] name the name of the counter (not copied)
+@return the counter
+*/
+Metric *metric_counter(String name);
+
+/**
+Gets the gauge of the given name. Registers it on the first call. Exits the program if there is a metric of another kind with this name or if @ref METRICS_MAX metrics are registered.
+@param[in] name the name of the gauge (not copied)
+@return the gauge
+*/
+Metric *metric_gauge(String name);
+
+/**
+Gets the histogram of the given name. Registers it on the first call. Exits the program if there is a metric of another kind with this name or if too many metrics are registered.
+@param[in] name the name of the histogram (not copied)
+@return the histogram
+*/
+Metric *metric_histogram(String name);
+
+/**
+Adds to a counter or a gauge.
+@param[in,out] m the counter or gauge
+@param[in] n the value to add, may be negative for gauges
+*/
+void metric_add(Metric *m, int64_t n);
+
+/**
+Sets the value of a gauge.
+@param[in,out] m the gauge
+@param[in] value the new value
+*/
+void metric_set(Metric *m, int64_t value);
+
+/**
+Records a value in a histogram. Takes constant time.
+@param[in,out] m the histogram
+@param[in] value the value to record
+*/
+void metric_record(Metric *m, int64_t value);
+
+/**
+Gets the value of a counter, added up over all threads, or of a gauge.
+@param[in] m the counter or gauge
+@return the value
+*/
+int64_t metric_value(Metric *m);
+
+/**
+Gets the values recorded in a histogram on all threads, merged into one Histogram.
+@param[in] m the histogram
+@return the merged values, free them with @ref hist_free
+*/
+Histogram *metric_snapshot(Metric *m);
+
+/**
+Prints all metrics, sorted by kind and name.
+@param[in] f the stream to print to, e.g., @c stdout
+@param[in] format the format
+*/
+void metrics_print(FILE *f, MetricsFormat format);
+
+/**
+Prints all metrics when the program exits.
+@param[in] file the file to write to, or NULL for @c stderr
+@param[in] format the format
+*/
+void metrics_print_at_exit(String file, MetricsFormat format);
+
+#endif
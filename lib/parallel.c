@@ -0,0 +1,121 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <pthread.h>
+#include <unistd.h>
+#include "parallel.h"
+#include "mapfile.h"
+#include "profile.h"
+
+// Number of chunks per thread. More chunks than threads balance the load
+// if some chunks take longer than others.
+#define CHUNKS_PER_THREAD 8
+
+// Smallest chunk size worth handing to a thread.
+#define MIN_CHUNK_SIZE (64 * 1024)
+
+// Size of a cache line. Each partial result starts on its own cache line,
+// so that threads that update neighboring results do not slow each other down.
+#define CACHE_LINE_SIZE 64
+
+typedef struct MapReduceJob {
+    Chunk *chunks;
+    int n_chunks;
+    int next_chunk; // index of the next chunk to process, taken atomically
+    Byte *results; // partial results, slot_size bytes per chunk, aligned to a cache line
+    size_t slot_size; // result_size rounded up to whole cache lines
+    ChunkMapper map;
+    Any context;
+} MapReduceJob;
+
+static void *map_chunks(void *arg) {
+    MapReduceJob *job = arg;
+    profile_register_thread();
+    int i;
+    while ((i = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED)) < job->n_chunks) {
+        job->map(job->chunks[i], job->results + i * job->slot_size, job->context);
+    }
+    return NULL;
+}
+
+// Splits the buffer into at most max_chunks chunks that end after a line break.
+static int split_chunks(const Byte *data, size_t n, int max_chunks, Chunk *chunks) {
+    size_t chunk_size = n / max_chunks + 1;
+    if (chunk_size < MIN_CHUNK_SIZE) chunk_size = MIN_CHUNK_SIZE;
+    int n_chunks = 0;
+    size_t start = 0;
+    while (start < n) {
+        size_t end = start + chunk_size;
+        if (end >= n || n_chunks == max_chunks - 1) {
+            end = n;
+        } else {
+            const Byte *nl = memchr(data + end, '\n', n - end);
+            end = (nl == NULL) ? n : (size_t)(nl - data) + 1;
+        }
+        Chunk c = { data + start, end - start, start, n_chunks };
+        chunks[n_chunks++] = c;
+        start = end;
+    }
+    return n_chunks;
+}
+
+void map_reduce_buffer(const Byte *data, size_t n, int n_threads, int result_size,
+        ChunkMapper map, ChunkReducer reduce, Any result, Any context)
+{
+    require("data not null", data != NULL || n == 0);
+    require("non-negative number of threads", n_threads >= 0);
+    require("positive result size", result_size > 0);
+    require_not_null(map);
+    require_not_null(reduce);
+    require_not_null(result);
+    if (n_threads == 0) n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_threads < 1) n_threads = 1;
+
+    int max_chunks = n_threads * CHUNKS_PER_THREAD;
+    MapReduceJob job;
+    job.chunks = xmalloc(max_chunks * sizeof(Chunk));
+    job.n_chunks = split_chunks(data, n, max_chunks, job.chunks);
+    job.next_chunk = 0;
+    job.slot_size = ((size_t)result_size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    Byte *results = xcalloc((job.n_chunks > 0 ? job.n_chunks : 1) * job.slot_size + CACHE_LINE_SIZE - 1, 1);
+    job.results = (Byte*)(((uintptr_t)results + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+    job.map = map;
+    job.context = context;
+
+    if (n_threads > job.n_chunks) n_threads = job.n_chunks;
+    if (n_threads <= 1) {
+        map_chunks(&job);
+    } else {
+        // the calling thread is one of the workers
+        pthread_t *threads = xmalloc((n_threads - 1) * sizeof(pthread_t));
+        for (int i = 0; i < n_threads - 1; i++) {
+            if (pthread_create(&threads[i], NULL, map_chunks, &job) != 0) {
+                fprintf(stderr, "%s: Cannot create thread.\n", (String)__func__);
+                base_exit(EXIT_FAILURE);
+            }
+        }
+        map_chunks(&job);
+        for (int i = 0; i < n_threads - 1; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        free(threads);
+    }
+
+    for (int i = 0; i < job.n_chunks; i++) {
+        reduce(result, job.results + i * job.slot_size, context);
+    }
+    free(results);
+    free(job.chunks);
+}
+
+void map_reduce_file(String name, int n_threads, int result_size,
+        ChunkMapper map, ChunkReducer reduce, Any result, Any context)
+{
+    require_not_null(name);
+    MappedFile m = map_file(name, ADVICE_WILLNEED);
+    map_reduce_buffer(m.data, m.size, n_threads, result_size, map, reduce, result, context);
+    unmap_file(&m);
+}
@@ -0,0 +1,93 @@
+/** @file
+Parallel processing of files. A file is split into chunks that end at line breaks. A map function processes each chunk on one of several threads and produces a partial result. A reduce function then combines the partial results in the order of the chunks.
+
+Example: Count the lines of a file in parallel.
+@code{.c}
+void count_lines(Chunk chunk, Any result, Any context) {
+    int lines = 0; // count locally, store the partial result of this chunk once
+    for (size_t i = 0; i < chunk.size; i++) {
+        if (chunk.data[i] == '\n') lines++;
+    }
+    *(int*)result = lines;
+}
+
+void add(Any result, ConstAny partial, Any context) {
+    *(int*)result += *(const int*)partial;
+}
+
+int main(void) {
+    int lines = 0;
+    map_reduce_file("big.txt", 0, sizeof(int), count_lines, add, &lines, NULL);
+    printiln(lines);
+    return 0;
+}
+@endcode
+
+The map function runs concurrently on several threads. It must not modify shared data without synchronization. It may allocate memory with @ref xmalloc. Each partial result is on its own cache lines. The map function should still accumulate in local variables and store the partial result at the end, which lets the compiler keep the values in registers.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include "base.h"
+
+/**
+A part of a file or buffer. Except for the last chunk, each chunk ends with a line break.
+*/
+typedef struct Chunk {
+    const Byte *data; ///< the bytes of the chunk (not zero-terminated)
+    size_t size; ///< number of bytes in the chunk
+    size_t offset; ///< position of the chunk in the file or buffer
+    int index; ///< number of the chunk, starting at 0
+} Chunk;
+
+/**
+Processes a chunk and stores the partial result. Called concurrently on several threads.
+@param[in] chunk the chunk to process
+@param[in,out] result the partial result for this chunk, @c result_size bytes, initially all zero
+@param[in] context the context given to @ref map_reduce_file
+*/
+typedef void (*ChunkMapper)(Chunk chunk, Any result, Any context);
+
+/**
+Combines a partial result into the result. Called on the calling thread, in the order of the chunks.
+@param[in,out] result the combined result so far
+@param[in] partial the partial result of the next chunk
+@param[in] context the context given to @ref map_reduce_file
+*/
+typedef void (*ChunkReducer)(Any result, ConstAny partial, Any context);
+
+/**
+Splits a buffer into chunks that end at line breaks, maps each chunk on a pool of threads, and reduces the partial results in chunk order into @c result.
+@param[in] data the buffer
+@param[in] n number of bytes in the buffer
+@param[in] n_threads number of threads, or 0 for the number of processors
+@param[in] result_size size of a (partial) result in bytes
+@param[in] map processes a chunk
+@param[in] reduce combines a partial result into the result
+@param[in,out] result the result, initialized by the caller (e.g., with 0 for counting)
+@param[in] context passed to @c map and @c reduce
+@pre "non-negative number of threads", n_threads >= 0
+@pre "positive result size", result_size > 0
+*/
+void map_reduce_buffer(const Byte *data, size_t n, int n_threads, int result_size,
+        ChunkMapper map, ChunkReducer reduce, Any result, Any context);
+
+/**
+Maps the file with the given name into memory and processes it with @ref map_reduce_buffer. Exits the program if the file cannot be opened.
+@param[in] name file name (including path)
+@param[in] n_threads number of threads, or 0 for the number of processors
+@param[in] result_size size of a (partial) result in bytes
+@param[in] map processes a chunk
+@param[in] reduce combines a partial result into the result
+@param[in,out] result the result, initialized by the caller (e.g., with 0 for counting)
+@param[in] context passed to @c map and @c reduce
+*/
+void map_reduce_file(String name, int n_threads, int result_size,
+        ChunkMapper map, ChunkReducer reduce, Any result, Any context);
+
+#endif
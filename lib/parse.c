@@ -0,0 +1,239 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <limits.h>
+#include <stdint.h>
+#include "parse.h"
+
+/** Size of the input buffer for reading numbers. */
+#define PARSE_BUFFER_SIZE (1024 * 1024)
+
+////////////////////////////////////////////////////////////////////////////
+// Tokens
+
+bool parse_int(const char *s, int n, int *result) {
+    require_not_null(s);
+    require_not_null(result);
+    int i = 0;
+    bool negative = false;
+    if (n > 0 && (s[0] == '-' || s[0] == '+')) {
+        negative = s[0] == '-';
+        i = 1;
+    }
+    if (i >= n) return false;
+    long long v = 0;
+    for (; i < n; i++) {
+        unsigned d = (Byte)s[i] - '0';
+        if (d > 9) return false;
+        v = 10 * v + d;
+        if (v > (long long)INT_MAX + 1) return false;
+    }
+    if (negative) v = -v;
+    if (v > INT_MAX) return false;
+    *result = (int)v;
+    return true;
+}
+
+// Powers of ten that are exactly representable as doubles.
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Converts the token with strtod, which handles all cases, but is slow.
+static bool parse_double_strtod(const char *s, int n, double *result) {
+    if (n == 0 || isspace((Byte)s[0])) return false;
+    char small[64];
+    char *t = (n < sizeof(small)) ? small : xmalloc(n + 1);
+    memcpy(t, s, n);
+    t[n] = '\0';
+    char *end = NULL;
+    double d = strtod(t, &end);
+    bool ok = end == t + n;
+    if (t != small) free(t);
+    if (ok) *result = d;
+    return ok;
+}
+
+bool parse_double(const char *s, int n, double *result) {
+    require_not_null(s);
+    require_not_null(result);
+    // fast path: up to 19 decimal digits with a small exponent (Clinger)
+    int i = 0;
+    bool negative = false;
+    if (n > 0 && (s[0] == '-' || s[0] == '+')) {
+        negative = s[0] == '-';
+        i = 1;
+    }
+    uint64_t m = 0; // mantissa
+    int n_digits = 0;
+    int e = 0; // decimal exponent
+    for (; i < n && (unsigned)((Byte)s[i] - '0') <= 9; i++) {
+        m = 10 * m + (s[i] - '0');
+        n_digits++;
+    }
+    if (i < n && s[i] == '.') {
+        for (i++; i < n && (unsigned)((Byte)s[i] - '0') <= 9; i++) {
+            m = 10 * m + (s[i] - '0');
+            n_digits++;
+            e--;
+        }
+    }
+    if (n_digits > 0 && i < n && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        bool negative_exponent = false;
+        if (i < n && (s[i] == '-' || s[i] == '+')) {
+            negative_exponent = s[i] == '-';
+            i++;
+        }
+        if (i >= n) return false;
+        int x = 0;
+        for (; i < n && (unsigned)((Byte)s[i] - '0') <= 9; i++) {
+            if (x < 100000) x = 10 * x + (s[i] - '0');
+        }
+        e += negative_exponent ? -x : x;
+    }
+    if (i == n && n_digits > 0 && n_digits <= 19 && m <= ((uint64_t)1 << 53) && e >= -22 && e <= 22) {
+        double d = (double)m;
+        d = (e < 0) ? d / exact_powers_of_ten[-e] : d * exact_powers_of_ten[e];
+        *result = negative ? -d : d;
+        return true;
+    }
+    // everything else: long mantissas, large exponents, hexadecimal, inf, nan, errors
+    return parse_double_strtod(s, n, result);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Bulk input
+
+// Reads numbers from f. If doubles is true, the result is a double array, otherwise an int array.
+static Any read_numbers(const char *function, FILE *f, String separators, bool doubles, int *n) {
+    require_not_null(f);
+    require_not_null(n);
+    if (separators == NULL) separators = PARSE_WHITESPACE;
+    require("separators not empty", *separators != '\0');
+
+    bool is_separator[256] = { false };
+    for (String s = separators; *s != '\0'; s++) {
+        is_separator[(Byte)*s] = true;
+    }
+
+    size_t element_size = doubles ? sizeof(double) : sizeof(int);
+    size_t count = 0;
+    size_t capacity = 1024;
+    Byte *a = xmalloc(capacity * element_size);
+
+    char *buffer = xmalloc(PARSE_BUFFER_SIZE);
+    int end = 0; // number of valid bytes in buffer
+    long base = 0; // offset of buffer[0] in the input
+    long line = 1; // current line number
+    long line_start = 0; // offset of the start of the current line in the input
+    bool eof = false;
+
+    while (!eof) {
+        int k = fread(buffer + end, 1, PARSE_BUFFER_SIZE - end, f);
+        if (k == 0) {
+            if (ferror(f)) {
+                fprintf(stderr, "%s: Cannot read from file.\n", function);
+                base_exit(EXIT_FAILURE);
+            }
+            eof = true;
+        }
+        end += k;
+
+        int i = 0;
+        for (;;) {
+            while (i < end && is_separator[(Byte)buffer[i]]) {
+                if (buffer[i] == '\n') {
+                    line++;
+                    line_start = base + i + 1;
+                }
+                i++;
+            }
+            if (i >= end) break;
+            int j = i + 1;
+            while (j < end && !is_separator[(Byte)buffer[j]]) j++;
+            if (j >= end && !eof) break; // the token may continue in the next block
+
+            if (count >= capacity) {
+                // the count is returned as an int
+                if (count >= INT_MAX) {
+                    fprintf(stderr, "%s: more than %d numbers at line %ld\n", function, INT_MAX, line);
+                    base_exit(EXIT_FAILURE);
+                }
+                capacity *= 2;
+                if (capacity > INT_MAX) capacity = INT_MAX;
+                a = xrealloc(a, capacity * element_size);
+            }
+            bool ok = doubles ? parse_double(buffer + i, j - i, (double*)a + count)
+                              : parse_int(buffer + i, j - i, (int*)a + count);
+            if (!ok) {
+                int length = j - i;
+                fprintf(stderr, "%s: malformed number \"%.*s%s\" at line %ld, column %ld\n",
+                        function, length < 40 ? length : 40, buffer + i, length < 40 ? "" : "...",
+                        line, base + i - line_start + 1);
+                base_exit(EXIT_FAILURE);
+            }
+            count++;
+            i = j;
+        }
+
+        // move the incomplete token to the front of the buffer
+        int rest = end - i;
+        if (rest >= PARSE_BUFFER_SIZE) {
+            fprintf(stderr, "%s: token too long at line %ld, column %ld\n",
+                    function, line, base + i - line_start + 1);
+            base_exit(EXIT_FAILURE);
+        }
+        memmove(buffer, buffer + i, rest);
+        base += i;
+        end = rest;
+    }
+
+    free(buffer);
+    *n = count;
+    return xrealloc(a, (count > 0 ? count : 1) * element_size);
+}
+
+static FILE *open_for_reading(const char *function, String name) {
+    require_not_null(name);
+    FILE *f = fopen(name, "r");
+    if (f == NULL) {
+        fprintf(stderr, "%s: Cannot open %s\n", function, name);
+        base_exit(EXIT_FAILURE);
+    }
+    return f;
+}
+
+int *ia_of_file(FILE *f, String separators, int *n) {
+    return read_numbers(__func__, f, separators, false, n);
+}
+
+int *ia_input(String separators, int *n) {
+    return read_numbers(__func__, stdin, separators, false, n);
+}
+
+int *ia_read_file(String name, String separators, int *n) {
+    FILE *f = open_for_reading(__func__, name);
+    int *a = read_numbers(__func__, f, separators, false, n);
+    fclose(f);
+    return a;
+}
+
+double *da_of_file(FILE *f, String separators, int *n) {
+    return read_numbers(__func__, f, separators, true, n);
+}
+
+double *da_input(String separators, int *n) {
+    return read_numbers(__func__, stdin, separators, true, n);
+}
+
+double *da_read_file(String name, String separators, int *n) {
+    FILE *f = open_for_reading(__func__, name);
+    double *a = read_numbers(__func__, f, separators, true, n);
+    fclose(f);
+    return a;
+}
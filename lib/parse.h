@@ -0,0 +1,111 @@
+/** @file
+Parsing numbers from text. The functions in this file convert character sequences to numbers without creating intermediate Strings. They can be used on single tokens or to read large amounts of numeric input into arrays in one pass.
+
+Example: Read all integers from standard input, separated by white space or commas.
+@code{.c}
+int n = 0;
+int *a = ia_input(" \t\r\n,", &n);
+printialn(a, n);
+free(a);
+@endcode
+
+If a token is not a valid number, the program exits with an error message that states the position of the token:
+
+    ia_input: malformed number "12x" at line 3, column 5
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __PARSE_H__
+#define __PARSE_H__
+
+#include "base.h"
+
+/** Separators used if @c NULL is given as separators: space, tab, carriage return, and line feed. */
+#define PARSE_WHITESPACE " \t\r\n"
+
+////////////////////////////////////////////////////////////////////////////
+// Tokens
+
+/**
+Converts the @c n characters at @c s to an integer. The characters have to consist of an optional sign followed by decimal digits. The number has to be in the range of @c int.
+@param[in] s first character, does not need to be zero-terminated
+@param[in] n number of characters
+@param[out] result the integer, if the conversion succeeds
+@return @c true if the characters form a valid integer, @c false otherwise
+*/
+bool parse_int(const char *s, int n, int *result);
+
+/**
+Converts the @c n characters at @c s to a double. Accepts the same formats as @c strtod. Short decimal numbers, which are the common case, are converted exactly without calling @c strtod.
+@param[in] s first character, does not need to be zero-terminated
+@param[in] n number of characters
+@param[out] result the double, if the conversion succeeds
+@return @c true if the characters form a valid double, @c false otherwise
+*/
+bool parse_double(const char *s, int n, double *result);
+
+////////////////////////////////////////////////////////////////////////////
+// Bulk input
+
+/**
+Reads all remaining integers from file @c f into a newly allocated array. The input is read in large blocks and parsed in one pass. The program exits with an error message stating line and column if a token is not a valid integer.
+@param[in] f file to read from
+@param[in] separators the characters that separate numbers, or @c NULL for @ref PARSE_WHITESPACE; a sequence of separators counts as a single separator
+@param[out] n number of integers read
+@return newly allocated array of @c n integers
+@see ia_input, ia_read_file, parse_int
+*/
+int *ia_of_file(FILE *f, String separators, int *n);
+
+/**
+Reads all remaining integers from standard input into a newly allocated array.
+@param[in] separators the characters that separate numbers, or @c NULL for @ref PARSE_WHITESPACE
+@param[out] n number of integers read
+@return newly allocated array of @c n integers
+@see ia_of_file
+*/
+int *ia_input(String separators, int *n);
+
+/**
+Reads all integers from the file with the given name into a newly allocated array.
+@param[in] name file name (including path)
+@param[in] separators the characters that separate numbers, or @c NULL for @ref PARSE_WHITESPACE
+@param[out] n number of integers read
+@return newly allocated array of @c n integers
+@see ia_of_file
+*/
+int *ia_read_file(String name, String separators, int *n);
+
+/**
+Reads all remaining doubles from file @c f into a newly allocated array. The input is read in large blocks and parsed in one pass. The program exits with an error message stating line and column if a token is not a valid double.
+@param[in] f file to read from
+@param[in] separators the characters that separate numbers, or @c NULL for @ref PARSE_WHITESPACE; a sequence of separators counts as a single separator
+@param[out] n number of doubles read
+@return newly allocated array of @c n doubles
+@see da_input, da_read_file, parse_double
+*/
+double *da_of_file(FILE *f, String separators, int *n);
+
+/**
+Reads all remaining doubles from standard input into a newly allocated array.
+@param[in] separators the characters that separate numbers, or @c NULL for @ref PARSE_WHITESPACE
+@param[out] n number of doubles read
+@return newly allocated array of @c n doubles
+@see da_of_file
+*/
+double *da_input(String separators, int *n);
+
+/**
+Reads all doubles from the file with the given name into a newly allocated array.
+@param[in] name file name (including path)
+@param[in] separators the characters that separate numbers, or @c NULL for @ref PARSE_WHITESPACE
+@param[out] n number of doubles read
+@return newly allocated array of @c n doubles
+@see da_of_file
+*/
+double *da_read_file(String name, String separators, int *n);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+#include "perfcount.h"
+
+static String event_names[PERF_EVENTS] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"
+};
+
+String perf_event_name(PerfEvent e) {
+    require("valid event", e >= 0 && e < PERF_EVENTS);
+    return event_names[e];
+}
+
+bool perf_has(PerfCounts c, PerfEvent e) {
+    require("valid event", e >= 0 && e < PERF_EVENTS);
+    return (c.available & (1 << e)) != 0;
+}
+
+#ifdef __linux__
+
+// The counters of a thread, read together as a group.
+typedef struct PerfGroup {
+    bool opened;
+    int leader; // file descriptor of the first counter, or -1 if there is none
+    int n; // number of counters in the group
+    PerfEvent events[PERF_EVENTS]; // the events in the order of the group
+    int fds[PERF_EVENTS]; // the file descriptors in the order of the group
+    int available;
+} PerfGroup;
+
+static __thread PerfGroup group = { false, -1, 0, { 0 }, { 0 }, 0 };
+static pthread_key_t group_key;
+static pthread_once_t group_key_once = PTHREAD_ONCE_INIT;
+
+// Closes the counters of an ending thread. Called by the thread itself.
+static void close_group(Any arg) {
+    PerfGroup *g = arg;
+    // the members first, the leader is the first of them
+    for (int i = g->n - 1; i >= 0; i--) close(g->fds[i]);
+    // counting in later destructors opens the counters again
+    g->opened = false;
+    g->leader = -1;
+    g->n = 0;
+    g->available = 0;
+}
+
+static void create_group_key(void) {
+    if (pthread_key_create(&group_key, close_group) != 0) {
+        fprintf(stderr, "perf_available: Cannot create thread key.\n");
+        base_exit(EXIT_FAILURE);
+    }
+}
+
+static void set_event(struct perf_event_attr *attr, PerfEvent e) {
+    switch (e) {
+        case PERF_CYCLES:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_BRANCH_MISSES:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PERF_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        default:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+    }
+}
+
+// Opens the counters of the calling thread. Events that cannot be opened are
+// left out, e.g., if the processor does not support them.
+static void open_group(void) {
+    group.opened = true;
+    for (PerfEvent e = 0; e < PERF_EVENTS; e++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        set_event(&attr, e);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group.leader, 0);
+        if (fd < 0) continue;
+        if (group.leader < 0) group.leader = fd;
+        group.events[group.n] = e;
+        group.fds[group.n++] = fd;
+        group.available |= 1 << e;
+    }
+    if (group.n > 0) {
+        pthread_once(&group_key_once, create_group_key);
+        pthread_setspecific(group_key, &group);
+    }
+}
+
+bool perf_available(void) {
+    if (!group.opened) open_group();
+    return group.available != 0;
+}
+
+PerfCounts perf_now(void) {
+    PerfCounts c;
+    memset(&c, 0, sizeof(c));
+    if (!perf_available()) return c;
+    // number of counters, time enabled, time running, values
+    uint64_t data[3 + PERF_EVENTS];
+    if (read(group.leader, data, sizeof(data)) < (ssize_t)((3 + group.n) * sizeof(uint64_t))) return c;
+    uint64_t enabled = data[1], running = data[2];
+    // the group has not been on the processor yet, nothing to extrapolate from
+    if (running == 0) return c;
+    for (int i = 0; i < group.n; i++) {
+        double value = data[3 + i];
+        // the counters were shared with other groups, extrapolate
+        if (running < enabled) value *= (double)enabled / running;
+        c.values[group.events[i]] = (int64_t)value;
+    }
+    c.available = group.available;
+    return c;
+}
+
+#else
+
+bool perf_available(void) {
+    return false;
+}
+
+PerfCounts perf_now(void) {
+    PerfCounts c;
+    memset(&c, 0, sizeof(c));
+    return c;
+}
+
+#endif
+
+PerfCounts perf_since(PerfCounts start) {
+    PerfCounts c = perf_now();
+    c.available &= start.available;
+    for (PerfEvent e = 0; e < PERF_EVENTS; e++) {
+        c.values[e] = perf_has(c, e) ? c.values[e] - start.values[e] : 0;
+    }
+    return c;
+}
+
+void perf_print(FILE *f, PerfCounts c) {
+    require_not_null(f);
+    if (c.available == 0) {
+        fprintf(f, "no performance counters available\n");
+        return;
+    }
+    String separator = "";
+    for (PerfEvent e = 0; e < PERF_EVENTS; e++) {
+        if (perf_has(c, e)) {
+            fprintf(f, "%s%s %lld", separator, event_names[e], (long long)c.values[e]);
+            separator = ", ";
+        }
+    }
+    if (perf_has(c, PERF_CYCLES) && perf_has(c, PERF_INSTRUCTIONS) && c.values[PERF_CYCLES] > 0) {
+        fprintf(f, ", %.2f instructions/cycle", (double)c.values[PERF_INSTRUCTIONS] / c.values[PERF_CYCLES]);
+    }
+    fprintf(f, "\n");
+}
@@ -0,0 +1,88 @@
+/** @file
+Hardware performance counters. The processor counts events such as cycles, instructions, mispredicted branches, and cache misses, which tell why a piece of code is slow, not just that it is slow. The counters are read with the @c perf_event_open system call of Linux and count only the calling thread in user mode.
+
+Example: Count the events of a code region, in the same way as time_now and time_ms_since measure its time.
+@code{.c}
+PerfCounts start = perf_now();
+do_work();
+PerfCounts c = perf_since(start);
+if (perf_has(c, PERF_INSTRUCTIONS)) {
+    printf("%lld instructions\n", (long long)c.values[PERF_INSTRUCTIONS]);
+}
+perf_print(stdout, c);
+@endcode
+
+Counters may be unavailable, e.g., in virtual machines without access to the performance monitoring unit, if @c /proc/sys/kernel/perf_event_paranoid forbids their use, or on other operating systems. Then the functions still work, but the counts do not contain the unavailable events. Use @ref perf_has to check.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __PERFCOUNT_H__
+#define __PERFCOUNT_H__
+
+#include "base.h"
+
+/**
+The events that are counted.
+*/
+typedef enum PerfEvent {
+    PERF_CYCLES, ///< processor cycles
+    PERF_INSTRUCTIONS, ///< instructions executed
+    PERF_BRANCH_MISSES, ///< mispredicted branches
+    PERF_L1D_MISSES, ///< level 1 data cache misses on reads
+    PERF_LLC_MISSES, ///< last level cache misses
+    PERF_EVENTS ///< number of events
+} PerfEvent;
+
+/**
+Counter values. After @ref perf_since these are the counts of a region.
+*/
+typedef struct PerfCounts {
+    int64_t values[PERF_EVENTS]; ///< the counts, indexed by PerfEvent
+    int available; ///< bit e is set if event e is counted
+} PerfCounts;
+
+/**
+Checks whether any counters are available on the calling thread. Opens the counters on the first call on each thread, they are closed when the thread ends.
+@return @c true if at least one event is counted
+*/
+bool perf_available(void);
+
+/**
+Reads the counters of the calling thread. Only differences between two such values are meaningful. The events are counted as one group, which is on the processor either with all of its events or not at all. If the processor's counters are shared, e.g., with other programs, the group is counted only part of the time and the counts are extrapolated. Until the group has been counted at all, the counts are unavailable.
+@return the current counter values
+*/
+PerfCounts perf_now(void);
+
+/**
+Computes the counts since the given counter values.
+@param[in] start counter values obtained from @ref perf_now on the same thread
+@return the counts of the events since @c start
+*/
+PerfCounts perf_since(PerfCounts start);
+
+/**
+Checks whether an event is counted.
+@param[in] c the counts
+@param[in] e the event
+@return @c true if @c c contains a count for @c e
+*/
+bool perf_has(PerfCounts c, PerfEvent e);
+
+/**
+Gets a short name of an event, e.g., "cycles" or "branch_misses".
+@param[in] e the event
+@return the name
+*/
+String perf_event_name(PerfEvent e);
+
+/**
+Prints the available counts on one line, with instructions per cycle if cycles and instructions are available, or a note that no counters are available.
+@param[in] f the stream to print to, e.g., @c stdout
+@param[in] c the counts
+*/
+void perf_print(FILE *f, PerfCounts c);
+
+#endif
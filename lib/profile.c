@@ -0,0 +1,337 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#define _GNU_SOURCE // dladdr, dl_iterate_phdr, REG_RIP
+#include <dlfcn.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "profile.h"
+
+// A sample is stored as its number of frames n, followed by n program
+// counters, innermost first. A count of 0 ends the samples.
+static Any *buffer = NULL;
+static size_t buffer_used = 0;
+static int n_samples = 0;
+static int n_dropped = 0;
+static bool sampling = false;
+static bool handler_installed = false;
+static String profile_file = NULL;
+static bool write_at_exit_registered = false;
+
+// The stack of the calling thread, found by profile_register_thread, since
+// the handler cannot look it up. The initial-exec model keeps the access free
+// of function calls also when the library is linked dynamically.
+static __thread __attribute__((tls_model("initial-exec"))) uintptr_t stack_low = 0;
+static __thread __attribute__((tls_model("initial-exec"))) uintptr_t stack_high = 0;
+
+// Maximum distance between successive frame pointers, a larger step means
+// that the frame pointer register held something else.
+#define MAX_FRAME_SIZE (100 * 1024)
+
+////////////////////////////////////////////////////////////////////////////
+// Sampling
+
+// Records the call stack of the interrupted thread. Follows the chain of frame
+// pointers from the registers of the interrupted code: a frame starts with the
+// frame pointer of the caller, followed by the return address. Calls no functions,
+// since most are not safe in a signal handler, e.g., backtrace may wait for the lock
+// of the dynamic loader. The walk ends at a frame pointer that is not further up
+// the stack, that is more than MAX_FRAME_SIZE above the previous one, or that is
+// outside of the stack of the thread. For a thread whose stack is unknown, only
+// the interrupted function is recorded.
+static void on_sigprof(int signal, siginfo_t *info, Any context) {
+    if (!__atomic_load_n(&sampling, __ATOMIC_RELAXED)) return;
+    Any frames[PROFILE_MAX_DEPTH];
+    int n = 0;
+#if defined(__x86_64__) && defined(REG_RIP)
+    greg_t *registers = ((ucontext_t*)context)->uc_mcontext.gregs;
+    frames[n++] = (Any)registers[REG_RIP];
+    uintptr_t low = registers[REG_RSP];
+    uintptr_t high = stack_high;
+    uintptr_t fp = registers[REG_RBP];
+    if (high == 0 || low < stack_low || low >= high) fp = 0; // e.g., on a signal stack
+    high -= 2 * sizeof(Any);
+    while (n < PROFILE_MAX_DEPTH && fp >= low && fp <= high && fp - low <= MAX_FRAME_SIZE
+            && fp % sizeof(Any) == 0) {
+        Any *frame = (Any*)fp;
+        if (frame[1] == NULL) break;
+        frames[n++] = frame[1];
+        low = fp + 2 * sizeof(Any);
+        fp = (uintptr_t)frame[0];
+    }
+#endif
+    if (n > 0) {
+        size_t position = __atomic_fetch_add(&buffer_used, n + 1, __ATOMIC_RELAXED);
+        if (position + n + 1 < PROFILE_BUFFER_SIZE) { // keep one entry for the end marker
+            for (int i = 0; i < n; i++) buffer[position + 1 + i] = frames[i];
+            buffer[position] = (Any)(intptr_t)n;
+            __atomic_fetch_add(&n_samples, 1, __ATOMIC_RELAXED);
+        } else {
+            // later samples start even further back, so this entry is ours
+            if (position < PROFILE_BUFFER_SIZE) buffer[position] = NULL;
+            __atomic_fetch_add(&n_dropped, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void write_at_exit(void) {
+    profile_stop();
+    if (profile_file != NULL) profile_write(profile_file);
+}
+
+void profile_start(String file, int rate) {
+    require("non-negative rate", rate >= 0);
+    if (sampling) return;
+    if (rate == 0) rate = PROFILE_DEFAULT_RATE;
+    profile_file = file;
+    if (file != NULL && !write_at_exit_registered) {
+        atexit(write_at_exit);
+        write_at_exit_registered = true;
+    }
+    if (buffer == NULL) {
+        // the pages are only touched when samples are stored
+        buffer = xcalloc(PROFILE_BUFFER_SIZE, sizeof(Any));
+        // the buffer lives until the program exits, it is not a leak
+        base_untrack(buffer);
+    }
+    profile_register_thread();
+    if (!handler_installed) {
+        // the handler stays installed, a late signal after stopping must not
+        // terminate the program
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = on_sigprof;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, NULL) != 0) {
+            fprintf(stderr, "profile_start: Cannot install signal handler\n");
+            base_exit(EXIT_FAILURE);
+        }
+        handler_installed = true;
+    }
+    __atomic_store_n(&sampling, true, __ATOMIC_RELAXED);
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = (rate >= 1000000) ? 1 : 1000000 / rate;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        fprintf(stderr, "profile_start: Cannot start timer\n");
+        base_exit(EXIT_FAILURE);
+    }
+}
+
+void profile_register_thread(void) {
+    if (stack_high != 0) return;
+    pthread_attr_t attributes;
+    if (pthread_getattr_np(pthread_self(), &attributes) != 0) return;
+    Any address;
+    size_t size;
+    if (pthread_attr_getstack(&attributes, &address, &size) == 0) {
+        stack_low = (uintptr_t)address;
+        // a signal may arrive in between, it must not see the new end with the old start
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        stack_high = stack_low + size;
+    }
+    pthread_attr_destroy(&attributes);
+}
+
+void profile_stop(void) {
+    if (!sampling) return;
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    __atomic_store_n(&sampling, false, __ATOMIC_RELAXED);
+}
+
+int profile_samples(int *dropped) {
+    if (dropped != NULL) *dropped = __atomic_load_n(&n_dropped, __ATOMIC_RELAXED);
+    return __atomic_load_n(&n_samples, __ATOMIC_RELAXED);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Symbols
+
+typedef struct Symbol {
+    uintptr_t start;
+    uintptr_t size;
+    String name;
+} Symbol;
+
+// The functions of the program, from its symbol table.
+typedef struct SymbolTable {
+    Symbol *symbols;
+    int n;
+    uintptr_t load_address; // where the program was loaded, for position independent executables
+    Any image;
+    size_t image_size;
+} SymbolTable;
+
+static int find_load_address(struct dl_phdr_info *info, size_t size, Any data) {
+    *(uintptr_t*)data = info->dlpi_addr;
+    return 1; // the first object is the program
+}
+
+static int compare_symbols(ConstAny a, ConstAny b) {
+    uintptr_t x = ((const Symbol*)a)->start, y = ((const Symbol*)b)->start;
+    return (x > y) - (x < y);
+}
+
+// Reads the function symbols of the program. Leaves the table empty if the
+// program has no symbol table, e.g., because it was stripped.
+static SymbolTable read_symbols(void) {
+    SymbolTable t = { NULL, 0, 0, NULL, 0 };
+    dl_iterate_phdr(find_load_address, &t.load_address);
+    int fd = open("/proc/self/exe", O_RDONLY);
+    if (fd < 0) return t;
+    off_t size = lseek(fd, 0, SEEK_END);
+    Any image = (size > 0) ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (image == MAP_FAILED) return t;
+    t.image = image;
+    t.image_size = size;
+    const Byte *base = image;
+    const Elf64_Ehdr *header = image;
+    if (size < sizeof(Elf64_Ehdr) || memcmp(header->e_ident, ELFMAG, SELFMAG) != 0
+            || header->e_ident[EI_CLASS] != ELFCLASS64
+            || header->e_shoff + header->e_shnum * sizeof(Elf64_Shdr) > size) {
+        return t;
+    }
+    const Elf64_Shdr *sections = (const Elf64_Shdr*)(base + header->e_shoff);
+    // prefer the full symbol table, which also has static functions
+    const Elf64_Shdr *symbols = NULL;
+    for (int i = 0; i < header->e_shnum; i++) {
+        if (sections[i].sh_type == SHT_SYMTAB) symbols = &sections[i];
+    }
+    for (int i = 0; i < header->e_shnum && symbols == NULL; i++) {
+        if (sections[i].sh_type == SHT_DYNSYM) symbols = &sections[i];
+    }
+    if (symbols == NULL || symbols->sh_link >= header->e_shnum) return t;
+    const Elf64_Shdr *strings = &sections[symbols->sh_link];
+    if (symbols->sh_offset + symbols->sh_size > size || strings->sh_offset + strings->sh_size > size) return t;
+    const Elf64_Sym *s = (const Elf64_Sym*)(base + symbols->sh_offset);
+    int n = symbols->sh_size / sizeof(Elf64_Sym);
+    t.symbols = xmalloc((n + 1) * sizeof(Symbol));
+    for (int i = 0; i < n; i++) {
+        if (ELF64_ST_TYPE(s[i].st_info) != STT_FUNC || s[i].st_value == 0) continue;
+        if (s[i].st_name >= strings->sh_size) continue;
+        Symbol *symbol = &t.symbols[t.n++];
+        symbol->start = s[i].st_value;
+        symbol->size = s[i].st_size;
+        symbol->name = (String)(base + strings->sh_offset + s[i].st_name);
+    }
+    qsort(t.symbols, t.n, sizeof(Symbol), compare_symbols);
+    return t;
+}
+
+static void free_symbols(SymbolTable *t) {
+    if (t->symbols != NULL) free(t->symbols);
+    if (t->image != NULL) munmap(t->image, t->image_size);
+}
+
+// Finds the function of the program that contains the address, or NULL.
+static String find_symbol(SymbolTable *t, uintptr_t address) {
+    address -= t->load_address;
+    int low = 0, high = t->n - 1;
+    while (low <= high) { // find the last symbol that starts at or before the address
+        int middle = (low + high) / 2;
+        if (t->symbols[middle].start <= address) low = middle + 1;
+        else high = middle - 1;
+    }
+    if (high < 0) return NULL;
+    Symbol *s = &t->symbols[high];
+    if (address < s->start + s->size) return s->name;
+    return NULL;
+}
+
+// Writes the name of the function that contains pc into the buffer. The
+// symbol table of the program comes first, since dladdr only knows exported
+// functions and returns the nearest one for others.
+static void symbol_name(SymbolTable *t, Any pc, char *name, int n) {
+    String s = find_symbol(t, (uintptr_t)pc);
+    if (s != NULL) {
+        snprintf(name, n, "%s", s);
+        return;
+    }
+    Dl_info info;
+    if (dladdr(pc, &info) == 0) {
+        snprintf(name, n, "%p", pc);
+    } else if (info.dli_sname != NULL) {
+        snprintf(name, n, "%s", info.dli_sname);
+    } else {
+        // a function that is not exported, all of them are merged into one
+        // entry per library, otherwise flame graphs would split them up
+        const char *file = (info.dli_fname != NULL) ? info.dli_fname : "?";
+        if (strrchr(file, '/') != NULL) file = strrchr(file, '/') + 1;
+        snprintf(name, n, "[%s]", file);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Output
+
+static int compare_strings(ConstAny a, ConstAny b) {
+    return strcmp(*(const String*)a, *(const String*)b);
+}
+
+void profile_write(String file) {
+    require_not_null(file);
+    FILE *f = fopen(file, "w");
+    if (f == NULL) {
+        fprintf(stderr, "profile_write: Cannot open %s\n", file);
+        base_exit(EXIT_FAILURE);
+    }
+    SymbolTable symbols = read_symbols();
+    int n = profile_samples(NULL);
+    String *stacks = xmalloc((n + 1) * sizeof(String));
+    int k = 0;
+    size_t end = buffer_used < PROFILE_BUFFER_SIZE ? buffer_used : PROFILE_BUFFER_SIZE;
+    char name[256];
+    for (size_t position = 0; position < end && k < n; ) {
+        int depth = (int)(intptr_t)buffer[position];
+        if (depth == 0) break;
+        Any *frames = buffer + position + 1;
+        // outermost frame first, separated by ';'
+        int capacity = 256, length = 0;
+        String stack = xmalloc(capacity);
+        for (int i = depth - 1; i >= 0; i--) {
+            // return addresses point after the call, which may be the next function
+            Any pc = (i == 0) ? frames[i] : (Any)((uintptr_t)frames[i] - 1);
+            symbol_name(&symbols, pc, name, sizeof(name));
+            int m = strlen(name);
+            if (length + m + 2 > capacity) {
+                capacity = 2 * (length + m + 2);
+                stack = xrealloc(stack, capacity);
+            }
+            if (length > 0) stack[length++] = ';';
+            memcpy(stack + length, name, m);
+            length += m;
+        }
+        stack[length] = '\0';
+        stacks[k++] = stack;
+        position += depth + 1;
+    }
+    qsort(stacks, k, sizeof(String), compare_strings);
+    for (int i = 0; i < k; ) {
+        int j = i + 1;
+        while (j < k && strcmp(stacks[i], stacks[j]) == 0) j++;
+        fprintf(f, "%s %d\n", stacks[i], j - i);
+        i = j;
+    }
+    for (int i = 0; i < k; i++) free(stacks[i]);
+    free(stacks);
+    free_symbols(&symbols);
+    if (fclose(f) != 0) {
+        fprintf(stderr, "profile_write: Cannot write %s\n", file);
+        base_exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,75 @@
+/** @file
+A sampling CPU profiler. While the profiler runs, a timer interrupts the program at a fixed rate of its CPU time (SIGPROF), and the call stack of the interrupted thread is recorded. Functions that appear in many samples are where the program spends its time. The samples are written as folded stacks, one line per distinct call stack with the number of its samples, e.g.:
+@code{.c}
+main;load;s_read_file 12
+main;compute;sum_of_roots 230
+@endcode
+This is the input format of flame graph tools, e.g., @c flamegraph.pl or https://www.speedscope.app.
+
+Example: Profile a program and write the profile when it exits.
+@code{.c}
+int main(void) {
+    profile_start("profile.folded", 0); // default rate
+    compute();
+    return 0;
+}
+@endcode
+
+The call stack is found by following the frame pointers from the interrupted code (on x86-64, elsewhere no samples are recorded). The samples are stored in a buffer that is allocated when the profiler starts, so recording a sample calls no functions, allocates no memory, and takes no locks. When the buffer is full, further samples are counted but not stored. Function names are looked up when the profile is written: from the symbol table of the program, and from the exported symbols of shared libraries. Compile with @c -fno-omit-frame-pointer, which is the default only without optimization. A function without a frame pointer, e.g., in the C library, hides its caller or ends the call stack. The walk stays within the stack of the thread, which is looked up by @ref profile_register_thread. Threads of this library do so when they start, other threads should call it, otherwise their samples only contain the interrupted function. Functions that were inlined do not appear. When the profiler is not running, it costs nothing.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include "base.h"
+
+/**
+Default number of samples per second of CPU time.
+*/
+#define PROFILE_DEFAULT_RATE 1000
+
+/**
+Maximum number of stack frames per sample. Deeper stacks are cut off at the bottom (near main).
+*/
+#define PROFILE_MAX_DEPTH 64
+
+/**
+Number of stack frame entries in the sample buffer, about 8 bytes each.
+*/
+#define PROFILE_BUFFER_SIZE (4 * 1024 * 1024)
+
+/**
+Starts sampling. Samples of earlier runs of the profiler are kept. Has no effect if the profiler is already running.
+@param[in] file the file to write the profile to when the program exits, or NULL to write it only with @ref profile_write
+@param[in] rate number of samples per second of CPU time, or 0 for @ref PROFILE_DEFAULT_RATE; the kernel may round it down to its timer tick rate, often 250 or 1000 per second
+*/
+void profile_start(String file, int rate);
+
+/**
+Looks up the stack of the calling thread, which bounds the call stacks that are recorded for it. Called by @ref profile_start for its thread and by the threads that this library starts. Other threads should call it when they start. Has no effect if called again.
+*/
+void profile_register_thread(void);
+
+/**
+Stops sampling. The samples are kept.
+*/
+void profile_stop(void);
+
+/**
+Gets the number of samples so far.
+@param[out] dropped if not NULL, receives the number of samples that did not fit into the buffer
+@return the number of stored samples
+*/
+int profile_samples(int *dropped);
+
+/**
+Writes the samples as folded stacks, sorted by call stack. Should be called while the profiler is stopped. Exits the program if the file cannot be written.
+@param[in] file the file to write to
+*/
+void profile_write(String file);
+
+#endif
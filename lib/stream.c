@@ -0,0 +1,716 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#define _GNU_SOURCE // copy_file_range, splice
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "stream.h"
+#include "profile.h"
+
+////////////////////////////////////////////////////////////////////////////
+// Line reader
+
+static LineReader *lr_new(FILE *f, int fd, int buffer_size) {
+    if (buffer_size <= 0) buffer_size = LR_DEFAULT_BUFFER_SIZE;
+    LineReader *r = xmalloc(sizeof(LineReader));
+    r->f = f;
+    r->fd = fd;
+    r->close_at_end = false;
+    r->eof = false;
+    r->buffer = xmalloc(buffer_size);
+    r->capacity = buffer_size;
+    r->start = 0;
+    r->scanned = 0;
+    r->end = 0;
+    r->line_number = 0;
+    r->lz = NULL;
+    return r;
+}
+
+LineReader *lr_open(String name, int buffer_size) {
+    require_not_null(name);
+    FILE *f = fopen(name, "r");
+    if (f == NULL) {
+        fprintf(stderr, "%s: Cannot open %s\n", (String)__func__, name);
+        base_exit(EXIT_FAILURE);
+    }
+    LineReader *r = lr_new(f, -1, buffer_size);
+    r->close_at_end = true;
+    return r;
+}
+
+LineReader *lr_of_file(FILE *f, int buffer_size) {
+    require_not_null(f);
+    return lr_new(f, -1, buffer_size);
+}
+
+LineReader *lr_of_fd(int fd, int buffer_size) {
+    require("valid file descriptor", fd >= 0);
+    return lr_new(NULL, fd, buffer_size);
+}
+
+LineReader *lr_open_compressed(String name, int buffer_size) {
+    require_not_null(name);
+    LineReader *r = lr_new(NULL, -1, buffer_size);
+    r->lz = lz_open(name);
+    return r;
+}
+
+// Reads at most n bytes into p. Returns the number of bytes read, 0 at end of input.
+static int lr_fill(LineReader *r, char *p, int n) {
+    if (r->lz != NULL) return lz_read(r->lz, p, n);
+    if (r->f != NULL) {
+        int k = fread(p, 1, n, r->f);
+        if (k == 0 && ferror(r->f)) {
+            fprintf(stderr, "%s: Cannot read from file.\n", (String)__func__);
+            base_exit(EXIT_FAILURE);
+        }
+        base_metric_add(BASE_METRIC_BYTES_READ, k);
+        return k;
+    }
+    for (;;) {
+        ssize_t k = read(r->fd, p, n);
+        if (k >= 0) {
+            base_metric_add(BASE_METRIC_BYTES_READ, k);
+            return k;
+        }
+        if (errno != EINTR) {
+            fprintf(stderr, "%s: Cannot read from file descriptor %d.\n", (String)__func__, r->fd);
+            base_exit(EXIT_FAILURE);
+        }
+    }
+}
+
+bool lr_next(LineReader *r, StringView *line) {
+    require_not_null(r);
+    require_not_null(line);
+    for (;;) {
+        char *p = r->buffer + r->start;
+        char *q = r->buffer + r->scanned;
+        char *nl = memchr(q, '\n', r->end - r->scanned);
+        if (nl != NULL) {
+            int n = nl - p;
+            r->start += n + 1;
+            r->scanned = r->start;
+            if (n > 0 && p[n - 1] == '\r') n--;
+            *line = make_string_view(p, n);
+            r->line_number++;
+            return true;
+        }
+        r->scanned = r->end;
+        if (r->eof) {
+            int n = r->end - r->start;
+            if (n == 0) return false;
+            // last line without line break
+            r->start = r->scanned = r->end;
+            if (p[n - 1] == '\r') n--;
+            *line = make_string_view(p, n);
+            r->line_number++;
+            return true;
+        }
+
+        // move the incomplete line to the front, grow the buffer if the line fills it
+        int n = r->end - r->start;
+        if (r->start > 0) {
+            memmove(r->buffer, p, n);
+            r->start = 0;
+            r->scanned = r->end = n;
+        }
+        if (r->end == r->capacity) {
+            r->capacity *= 2;
+            r->buffer = xrealloc(r->buffer, r->capacity);
+        }
+        int k = lr_fill(r, r->buffer + r->end, r->capacity - r->end);
+        if (k == 0) r->eof = true;
+        r->end += k;
+    }
+}
+
+void lr_close(LineReader *r) {
+    require_not_null(r);
+    if (r->close_at_end) fclose(r->f);
+    if (r->lz != NULL) lz_close(r->lz);
+    free(r->buffer);
+    free(r);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// File writer
+
+// Reports the failed operation, removes the temporary file (if any), and exits.
+static void fw_fail(FileWriter *w, String operation) {
+    fprintf(stderr, "FileWriter: Cannot %s %s: %s\n", operation, 
+            w->name != NULL ? w->name : "file descriptor", strerror(errno));
+    if (w->temp_name != NULL) unlink(w->temp_name);
+    base_exit(EXIT_FAILURE);
+}
+
+static FileWriter *fw_new(int fd, int flags, int buffer_size) {
+    if (buffer_size <= 0) buffer_size = FW_DEFAULT_BUFFER_SIZE;
+    if (buffer_size < 64) buffer_size = 64;
+    FileWriter *w = xmalloc(sizeof(FileWriter));
+    w->fd = fd;
+    w->flags = flags;
+    w->close_at_end = false;
+    w->name = NULL;
+    w->temp_name = NULL;
+    w->buffer = xmalloc(buffer_size);
+    w->capacity = buffer_size;
+    w->length = 0;
+    w->bytes_written = 0;
+    w->packed = NULL;
+    return w;
+}
+
+static void fw_write_all(FileWriter *w, struct iovec *iov, int count);
+
+// Creates the temporary file of an atomic writer. Its name is the name of the
+// target followed by '.' and 6 random characters, which temp_name has room for.
+// Unlike mkstemp, which always uses mode 0600, open applies the umask to the mode,
+// as for any new file.
+static int fw_create_temp(String temp_name, int n, mode_t mode) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    uint64_t x = time_ns() ^ ((uint64_t)getpid() << 32) ^ (uintptr_t)temp_name;
+    for (int attempt = 0; attempt < 100; attempt++) {
+        temp_name[n] = '.';
+        for (int i = 1; i <= 6; i++) {
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+            temp_name[n + i] = letters[(x >> 33) % 62];
+        }
+        temp_name[n + 7] = '\0';
+        int fd = open(temp_name, O_WRONLY | O_CREAT | O_EXCL, mode);
+        if (fd >= 0 || errno != EEXIST) return fd;
+    }
+    return -1;
+}
+
+FileWriter *fw_open(String name, int flags, int buffer_size) {
+    require_not_null(name);
+    require("not both atomic and append", !((flags & FW_ATOMIC) && (flags & FW_APPEND)));
+    require("not both compress and append", !((flags & FW_COMPRESS) && (flags & FW_APPEND)));
+    FileWriter *w = fw_new(-1, flags, buffer_size);
+    w->name = s_copy(name);
+    w->close_at_end = true;
+    if (flags & FW_ATOMIC) {
+        // the replaced target keeps its mode, a new one gets the usual mode
+        struct stat target;
+        bool exists = stat(name, &target) == 0;
+        int n = strlen(name);
+        w->temp_name = xmalloc(n + 8);
+        memcpy(w->temp_name, name, n);
+        w->fd = fw_create_temp(w->temp_name, n, exists ? target.st_mode & 07777 : 0666);
+        if (w->fd < 0) {
+            free(w->temp_name);
+            w->temp_name = NULL;
+            fw_fail(w, "create temporary file for");
+        }
+        // the umask applies to the new file, the target's mode must be copied exactly
+        if (exists && fchmod(w->fd, target.st_mode & 07777) != 0) fw_fail(w, "set the mode of the temporary file for");
+    } else {
+        int mode = O_WRONLY | O_CREAT | ((flags & FW_APPEND) ? O_APPEND : O_TRUNC);
+        w->fd = open(name, mode, 0666);
+        if (w->fd < 0) fw_fail(w, "open");
+    }
+    if (flags & FW_COMPRESS) {
+        w->packed = xmalloc(lz_block_bound(w->capacity));
+        struct iovec iov = { LZ_MAGIC, strlen(LZ_MAGIC) };
+        fw_write_all(w, &iov, 1);
+    }
+    return w;
+}
+
+FileWriter *fw_of_fd(int fd, int buffer_size) {
+    require("valid file descriptor", fd >= 0);
+    return fw_new(fd, 0, buffer_size);
+}
+
+// Maximum number of parts for writev, the POSIX minimum of IOV_MAX.
+#define FW_MAX_PARTS 1024
+
+// Writes all data described by iov, continuing after partial writes.
+static void fw_write_all(FileWriter *w, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t k = writev(w->fd, iov, count < FW_MAX_PARTS ? count : FW_MAX_PARTS);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            fw_fail(w, "write to");
+        }
+        base_metric_add(BASE_METRIC_BYTES_WRITTEN, k);
+        // skip the parts that have been written completely
+        while (count > 0 && (size_t)k >= iov->iov_len) {
+            k -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + k;
+            iov->iov_len -= k;
+        }
+    }
+}
+
+void fw_flush(FileWriter *w) {
+    require_not_null(w);
+    if (w->length > 0) {
+        struct iovec iov = { w->buffer, w->length };
+        if (w->packed != NULL) {
+            iov.iov_base = w->packed;
+            iov.iov_len = lz_write_block((Byte*)w->buffer, w->length, w->packed);
+        }
+        fw_write_all(w, &iov, 1);
+        w->length = 0;
+    }
+}
+
+// Passes data through the buffer, such that each full buffer is compressed as a block.
+static void fw_write_compressed(FileWriter *w, const void *data, size_t n) {
+    const char *p = data;
+    while (n > 0) {
+        size_t k = w->capacity - w->length;
+        if (k > n) k = n;
+        memcpy(w->buffer + w->length, p, k);
+        w->length += k;
+        p += k;
+        n -= k;
+        if (w->length == w->capacity) fw_flush(w);
+    }
+}
+
+void fw_write(FileWriter *w, const void *data, size_t n) {
+    require_not_null(w);
+    require_not_null(data);
+    w->bytes_written += n;
+    if (n <= w->capacity - w->length) {
+        memcpy(w->buffer + w->length, data, n);
+        w->length += n;
+    } else if (w->packed != NULL) {
+        fw_write_compressed(w, data, n);
+    } else if (n < w->capacity) {
+        fw_flush(w);
+        memcpy(w->buffer, data, n);
+        w->length = n;
+    } else { // large block: write buffer and block together, without copying
+        struct iovec iov[2] = { { w->buffer, w->length }, { (void*)data, n } };
+        fw_write_all(w, iov, 2);
+        w->length = 0;
+    }
+}
+
+void fw_writev(FileWriter *w, StringView *parts, int n) {
+    require_not_null(w);
+    require_not_null(parts);
+    require("non-negative length", n >= 0);
+    size_t total = 0;
+    for (int i = 0; i < n; i++) total += parts[i].length;
+    w->bytes_written += total;
+    if (total <= w->capacity - w->length) {
+        for (int i = 0; i < n; i++) {
+            memcpy(w->buffer + w->length, parts[i].s, parts[i].length);
+            w->length += parts[i].length;
+        }
+        return;
+    }
+    if (w->packed != NULL) {
+        for (int i = 0; i < n; i++) fw_write_compressed(w, parts[i].s, parts[i].length);
+        return;
+    }
+    struct iovec small[16];
+    struct iovec *iov = (n + 1 <= 16) ? small : xmalloc((n + 1) * sizeof(struct iovec));
+    iov[0].iov_base = w->buffer;
+    iov[0].iov_len = w->length;
+    for (int i = 0; i < n; i++) {
+        iov[i + 1].iov_base = (void*)parts[i].s;
+        iov[i + 1].iov_len = parts[i].length;
+    }
+    fw_write_all(w, iov, n + 1);
+    w->length = 0;
+    if (iov != small) free(iov);
+}
+
+void fw_prints(FileWriter *w, String s) {
+    require_not_null(s);
+    fw_write(w, s, strlen(s));
+}
+
+void fw_printc(FileWriter *w, char c) {
+    require_not_null(w);
+    if (w->length >= w->capacity) fw_flush(w);
+    w->buffer[w->length++] = c;
+    w->bytes_written++;
+}
+
+void fw_printi(FileWriter *w, int i) {
+    require_not_null(w);
+    char digits[12];
+    char *p = digits + sizeof(digits);
+    unsigned u = (i < 0) ? -(unsigned)i : (unsigned)i;
+    do {
+        *--p = '0' + u % 10;
+        u /= 10;
+    } while (u > 0);
+    if (i < 0) *--p = '-';
+    fw_write(w, p, digits + sizeof(digits) - p);
+}
+
+void fw_printd(FileWriter *w, double d) {
+    char s[32];
+    int n = snprintf(s, sizeof(s), "%g", d);
+    fw_write(w, s, n);
+}
+
+void fw_printf(FileWriter *w, const char *format, ...) {
+    require_not_null(w);
+    require_not_null(format);
+    va_list args;
+    va_start(args, format);
+    int free_space = w->capacity - w->length;
+    int n = vsnprintf(w->buffer + w->length, free_space, format, args);
+    va_end(args);
+    if (n < free_space) { // fits into buffer, +1 for '\0' written by vsnprintf
+        w->length += n;
+        w->bytes_written += n;
+        return;
+    }
+    char *s = xmalloc(n + 1);
+    va_start(args, format);
+    vsnprintf(s, n + 1, format, args);
+    va_end(args);
+    fw_write(w, s, n);
+    free(s);
+}
+
+// Forces the directory entry of the given file to disk, such that a rename survives a crash.
+static void fw_sync_directory(FileWriter *w) {
+    String slash = strrchr(w->name, '/');
+    String dir = (slash == NULL) ? s_copy(".") : s_copy(w->name);
+    if (slash != NULL) dir[slash - w->name + (slash == w->name ? 1 : 0)] = '\0';
+    int fd = open(dir, O_RDONLY);
+    free(dir);
+    if (fd < 0 || fsync(fd) != 0) fw_fail(w, "sync directory of");
+    close(fd);
+}
+
+void fw_close(FileWriter *w) {
+    require_not_null(w);
+    fw_flush(w);
+    if (w->packed != NULL) {
+        Byte end_marker[4] = { 0, 0, 0, 0 };
+        struct iovec iov = { end_marker, sizeof(end_marker) };
+        fw_write_all(w, &iov, 1);
+        free(w->packed);
+    }
+    if ((w->flags & FW_SYNC) && fsync(w->fd) != 0) fw_fail(w, "sync");
+    if (w->close_at_end && close(w->fd) != 0) fw_fail(w, "close");
+    if (w->temp_name != NULL) {
+        if (rename(w->temp_name, w->name) != 0) fw_fail(w, "rename temporary file to");
+        if (w->flags & FW_SYNC) fw_sync_directory(w);
+        free(w->temp_name);
+    }
+    if (w->name != NULL) free(w->name);
+    free(w->buffer);
+    free(w);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Prefetching reader
+
+struct PrefetchReader {
+    int fd; // file descriptor to read from
+    bool close_at_end; // whether the reader opened the file itself
+    int wake[2]; // pipe that pr_close closes to wake the background thread, -1 for regular files
+    int block_size; // capacity of each block
+    int block_count; // number of blocks
+    Byte **blocks; // the blocks
+    int *lengths; // number of valid bytes of each block
+    int head; // index of next block to hand out to the caller
+    int tail; // index of next block to fill
+    int full; // number of filled blocks, including the one held by the caller
+    bool holding; // whether the caller holds block head
+    bool eof; // whether the background thread has reached the end of the input
+    bool stop; // whether the background thread has to stop
+    int error; // errno of a failed read, 0 otherwise
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_full; // signaled when a block becomes free
+    pthread_cond_t not_empty; // signaled when a block has been filled or at end of input
+};
+
+// Fills the block. Returns the number of bytes read, or -1 on error. A regular
+// file is read until the block is full. A pipe or socket may block for a long
+// time, so the background thread waits for data or for pr_close, and hands out
+// each read right away.
+static int pr_fill(PrefetchReader *r, Byte *block, int n) {
+    int length = 0;
+    while (length < n) {
+        if (r->wake[0] >= 0) {
+            struct pollfd fds[2] = { { r->fd, POLLIN, 0 }, { r->wake[0], POLLIN, 0 } };
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (fds[1].revents != 0) break; // pr_close
+        }
+        ssize_t k = read(r->fd, block + length, n - length);
+        if (k == 0) break;
+        if (k < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            return -1;
+        }
+        length += k;
+        if (r->wake[0] >= 0) break;
+    }
+    base_metric_add(BASE_METRIC_BYTES_READ, length);
+    return length;
+}
+
+static void *pr_run(void *arg) {
+    PrefetchReader *r = arg;
+    profile_register_thread();
+    pthread_mutex_lock(&r->mutex);
+    while (!r->eof) {
+        while (!r->stop && r->full >= r->block_count) {
+            pthread_cond_wait(&r->not_full, &r->mutex);
+        }
+        if (r->stop) break;
+        int i = r->tail;
+        pthread_mutex_unlock(&r->mutex);
+        int length = pr_fill(r, r->blocks[i], r->block_size);
+        int error = errno;
+        pthread_mutex_lock(&r->mutex);
+        if (length < 0) {
+            r->error = error;
+            r->eof = true;
+        } else {
+            if (length == 0 || (length < r->block_size && r->wake[0] < 0)) r->eof = true;
+            if (length > 0) {
+                r->lengths[i] = length;
+                r->tail = (i + 1) % r->block_count;
+                r->full++;
+            }
+        }
+        pthread_cond_signal(&r->not_empty);
+    }
+    pthread_mutex_unlock(&r->mutex);
+    return NULL;
+}
+
+PrefetchReader *pr_of_fd(int fd, int block_size, int block_count) {
+    require("valid file descriptor", fd >= 0);
+    if (block_size <= 0) block_size = PR_DEFAULT_BLOCK_SIZE;
+    if (block_count <= 0) block_count = PR_DEFAULT_BLOCK_COUNT;
+    require("at least two blocks", block_count >= 2);
+    PrefetchReader *r = xcalloc(1, sizeof(PrefetchReader));
+    r->fd = fd;
+    r->wake[0] = r->wake[1] = -1;
+    struct stat st;
+    if ((fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) && pipe2(r->wake, O_CLOEXEC) != 0) {
+        fprintf(stderr, "%s: Cannot create pipe.\n", (String)__func__);
+        base_exit(EXIT_FAILURE);
+    }
+    r->block_size = block_size;
+    r->block_count = block_count;
+    // all memory is allocated here, the background thread only reads
+    r->blocks = xmalloc(block_count * sizeof(Byte*));
+    r->lengths = xcalloc(block_count, sizeof(int));
+    for (int i = 0; i < block_count; i++) {
+        r->blocks[i] = xmalloc(block_size);
+    }
+    pthread_mutex_init(&r->mutex, NULL);
+    pthread_cond_init(&r->not_full, NULL);
+    pthread_cond_init(&r->not_empty, NULL);
+    if (pthread_create(&r->thread, NULL, pr_run, r) != 0) {
+        fprintf(stderr, "%s: Cannot create thread.\n", (String)__func__);
+        base_exit(EXIT_FAILURE);
+    }
+    return r;
+}
+
+PrefetchReader *pr_open(String name, int block_size, int block_count) {
+    require_not_null(name);
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: Cannot open %s\n", (String)__func__, name);
+        base_exit(EXIT_FAILURE);
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    PrefetchReader *r = pr_of_fd(fd, block_size, block_count);
+    r->close_at_end = true;
+    return r;
+}
+
+bool pr_next(PrefetchReader *r, const Byte **data, int *n) {
+    require_not_null(r);
+    require_not_null(data);
+    require_not_null(n);
+    pthread_mutex_lock(&r->mutex);
+    if (r->holding) { // hand back the previous block
+        r->head = (r->head + 1) % r->block_count;
+        r->full--;
+        r->holding = false;
+        pthread_cond_signal(&r->not_full);
+    }
+    while (r->full == 0 && !r->eof) {
+        pthread_cond_wait(&r->not_empty, &r->mutex);
+    }
+    bool available = r->full > 0;
+    if (available) {
+        *data = r->blocks[r->head];
+        *n = r->lengths[r->head];
+        r->holding = true;
+    }
+    int error = r->error;
+    pthread_mutex_unlock(&r->mutex);
+    if (!available && error != 0) {
+        fprintf(stderr, "%s: Cannot read from file descriptor %d: %s\n", (String)__func__, r->fd, strerror(error));
+        base_exit(EXIT_FAILURE);
+    }
+    return available;
+}
+
+void pr_close(PrefetchReader *r) {
+    require_not_null(r);
+    pthread_mutex_lock(&r->mutex);
+    r->stop = true;
+    pthread_cond_signal(&r->not_full);
+    pthread_mutex_unlock(&r->mutex);
+    // ends the wait of the background thread for a pipe or socket
+    if (r->wake[1] >= 0) close(r->wake[1]);
+    pthread_join(r->thread, NULL);
+    if (r->wake[0] >= 0) close(r->wake[0]);
+    pthread_mutex_destroy(&r->mutex);
+    pthread_cond_destroy(&r->not_full);
+    pthread_cond_destroy(&r->not_empty);
+    if (r->close_at_end) close(r->fd);
+    for (int i = 0; i < r->block_count; i++) {
+        free(r->blocks[i]);
+    }
+    free(r->blocks);
+    free(r->lengths);
+    free(r);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Copying
+
+// Number of bytes to transfer per system call.
+#define COPY_CHUNK_SIZE (16 * 1024 * 1024)
+
+// Whether the error code means that the method is not supported for these files.
+static bool copy_unsupported(int error) {
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP
+        || error == EBADF || error == ENOTSUP || error == EPERM;
+}
+
+// Transfers data with the given kernel method. Returns false if the method is not 
+// supported. Otherwise returns true after having copied all data.
+static bool copy_with(int method, int from, int to, size_t *bytes) {
+    for (;;) {
+        ssize_t k;
+        switch (method) {
+            case 0: k = copy_file_range(from, NULL, to, NULL, COPY_CHUNK_SIZE, 0); break;
+            case 1: k = sendfile(to, from, NULL, COPY_CHUNK_SIZE); break;
+            default: k = splice(from, NULL, to, NULL, COPY_CHUNK_SIZE, SPLICE_F_MOVE | SPLICE_F_MORE); break;
+        }
+        if (k == 0) return true;
+        if (k > 0) {
+            *bytes += k;
+            base_metric_add(BASE_METRIC_BYTES_READ, k);
+            base_metric_add(BASE_METRIC_BYTES_WRITTEN, k);
+        } else if (errno != EINTR) {
+            if (*bytes == 0 && copy_unsupported(errno)) return false;
+            fprintf(stderr, "copy_fd: Cannot copy from file descriptor %d to %d: %s\n", from, to, strerror(errno));
+            base_exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void copy_with_buffer(int from, int to, size_t *bytes) {
+    int capacity = 1024 * 1024;
+    char *buffer = xmalloc(capacity);
+    for (;;) {
+        ssize_t k = read(from, buffer, capacity);
+        if (k == 0) break;
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "copy_fd: Cannot read from file descriptor %d: %s\n", from, strerror(errno));
+            base_exit(EXIT_FAILURE);
+        }
+        for (ssize_t i = 0; i < k; ) {
+            ssize_t m = write(to, buffer + i, k - i);
+            if (m < 0) {
+                if (errno == EINTR) continue;
+                fprintf(stderr, "copy_fd: Cannot write to file descriptor %d: %s\n", to, strerror(errno));
+                base_exit(EXIT_FAILURE);
+            }
+            i += m;
+        }
+        *bytes += k;
+        base_metric_add(BASE_METRIC_BYTES_READ, k);
+        base_metric_add(BASE_METRIC_BYTES_WRITTEN, k);
+    }
+    free(buffer);
+}
+
+CopyResult copy_fd(int from, int to) {
+    require("valid file descriptor", from >= 0);
+    require("valid file descriptor", to >= 0);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    struct stat from_stat, to_stat;
+    bool from_known = fstat(from, &from_stat) == 0;
+    bool from_file = from_known && S_ISREG(from_stat.st_mode);
+    bool from_pipe = from_known && S_ISFIFO(from_stat.st_mode);
+    bool to_pipe = fstat(to, &to_stat) == 0 && S_ISFIFO(to_stat.st_mode);
+
+    CopyResult r = { 0, 0, 0, "read/write" };
+    // files in /proc report size 0, some kernels then copy nothing with copy_file_range
+    if (from_file && from_stat.st_size > 0 && copy_with(0, from, to, &r.bytes)) {
+        r.method = "copy_file_range";
+    } else if (from_file && copy_with(1, from, to, &r.bytes)) {
+        r.method = "sendfile";
+    } else if ((from_pipe || to_pipe) && copy_with(2, from, to, &r.bytes)) {
+        r.method = "splice";
+    } else {
+        copy_with_buffer(from, to, &r.bytes);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    r.seconds = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+    r.mb_per_second = (r.seconds > 0) ? r.bytes / r.seconds / 1e6 : 0;
+    return r;
+}
+
+CopyResult copy_file(String from, String to) {
+    require_not_null(from);
+    require_not_null(to);
+    int fd_from = open(from, O_RDONLY);
+    if (fd_from < 0) {
+        fprintf(stderr, "%s: Cannot open %s\n", (String)__func__, from);
+        base_exit(EXIT_FAILURE);
+    }
+    struct stat st;
+    int mode = (fstat(fd_from, &st) == 0) ? (st.st_mode & 0777) : 0666;
+    int fd_to = open(to, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (fd_to < 0) {
+        fprintf(stderr, "%s: Cannot open %s\n", (String)__func__, to);
+        base_exit(EXIT_FAILURE);
+    }
+    CopyResult r = copy_fd(fd_from, fd_to);
+    close(fd_from);
+    if (close(fd_to) != 0) {
+        fprintf(stderr, "%s: Cannot write data to file %s.\n", (String)__func__, to);
+        base_exit(EXIT_FAILURE);
+    }
+    return r;
+}
@@ -0,0 +1,308 @@
+/** @file
+Streaming file input and output. The functions in this file read and write files in large blocks rather than character by character. They are meant for files that are too large to conveniently hold in memory as a whole, or for input that arrives through a pipe.
+
+<h3>Reading lines</h3>
+
+A @ref LineReader reads a file in large blocks and hands out the lines as views into its buffer. The lines are not copied.
+@code{.c}
+LineReader *r = lr_open("example.txt", 0);
+StringView line;
+while (lr_next(r, &line)) {
+    printf("%.*s\n", line.length, line.s);
+}
+lr_close(r);
+@endcode
+
+<h3>Writing files</h3>
+
+A @ref FileWriter collects small writes in a large buffer and writes the buffer in one system call when it is full. With @ref FW_ATOMIC, the data is written to a temporary file that replaces the target file only when the writer is closed, so other programs never see a partially written file.
+@code{.c}
+FileWriter *w = fw_open("squares.txt", FW_ATOMIC | FW_SYNC, 0);
+for (int i = 0; i < 1000; i++) {
+    fw_printi(w, i * i);
+    fw_printc(w, '\n');
+}
+fw_close(w);
+@endcode
+
+<h3>Reading ahead</h3>
+
+A @ref PrefetchReader reads blocks of a file in a background thread while the caller processes the current block, such that reading and processing overlap.
+@code{.c}
+PrefetchReader *r = pr_open("big.txt", 0, 0);
+const Byte *block;
+int n;
+while (pr_next(r, &block, &n)) {
+    process(block, n); // the next blocks are read in the meantime
+}
+pr_close(r);
+@endcode
+
+<h3>Copying files</h3>
+
+@ref copy_file and @ref copy_fd let the kernel move the data (with @c copy_file_range, @c sendfile, or @c splice), such that it is not copied to and from user space. If the kernel cannot do it for the given kind of files, they fall back to reading and writing large blocks.
+@code{.c}
+CopyResult r = copy_file("big.txt", "big_copy.txt");
+printf("%lu bytes in %g s using %s\n", (unsigned long)r.bytes, r.seconds, r.method);
+@endcode
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#include "base.h"
+#include "compress.h"
+
+////////////////////////////////////////////////////////////////////////////
+// Line reader
+
+/** Default buffer size of a line reader in bytes. */
+#define LR_DEFAULT_BUFFER_SIZE (256 * 1024)
+
+/**
+Reads lines from a file or file descriptor. The reader fills a large buffer with block reads and finds line breaks with @c memchr. Lines that span the end of the buffer are moved to its front. A line that is longer than the buffer makes the buffer grow.
+@see lr_open, lr_of_file, lr_of_fd, lr_next, lr_close
+*/
+typedef struct LineReader {
+    FILE *f; ///< file to read from, or NULL if reading from fd
+    int fd; ///< file descriptor to read from, if f is NULL
+    bool close_at_end; ///< whether the reader opened the file itself
+    bool eof; ///< whether the end of the input has been reached
+    char *buffer; ///< the input buffer
+    int capacity; ///< number of bytes allocated for buffer
+    int start; ///< index of first unconsumed byte in buffer
+    int scanned; ///< index up to which there is no line break in buffer
+    int end; ///< index after last valid byte in buffer
+    int line_number; ///< number of lines returned so far
+    LzReader *lz; ///< decompressor if reading a compressed file, otherwise NULL
+} LineReader;
+
+/**
+Opens the file with the given name for reading lines. Exits the program if the file cannot be opened.
+@param[in] name file name (including path)
+@param[in] buffer_size initial size of the input buffer in bytes, or 0 for @ref LR_DEFAULT_BUFFER_SIZE
+@return the line reader, close it with @ref lr_close
+*/
+LineReader *lr_open(String name, int buffer_size);
+
+/**
+Creates a line reader for an open file, e.g., @c stdin. The file is not closed by @ref lr_close.
+@param[in] f file to read from
+@param[in] buffer_size initial size of the input buffer in bytes, or 0 for @ref LR_DEFAULT_BUFFER_SIZE
+@return the line reader, close it with @ref lr_close
+*/
+LineReader *lr_of_file(FILE *f, int buffer_size);
+
+/**
+Creates a line reader for an open file descriptor. The file descriptor is not closed by @ref lr_close.
+@param[in] fd file descriptor to read from
+@param[in] buffer_size initial size of the input buffer in bytes, or 0 for @ref LR_DEFAULT_BUFFER_SIZE
+@return the line reader, close it with @ref lr_close
+*/
+LineReader *lr_of_fd(int fd, int buffer_size);
+
+/**
+Opens a compressed file (see @ref compress.h) for reading the lines of its decompressed contents. Exits the program if the file cannot be opened or is not a compressed file.
+@param[in] name file name (including path)
+@param[in] buffer_size initial size of the input buffer in bytes, or 0 for @ref LR_DEFAULT_BUFFER_SIZE
+@return the line reader, close it with @ref lr_close
+*/
+LineReader *lr_open_compressed(String name, int buffer_size);
+
+/**
+Gets the next line. The line break (@c "\n" or @c "\r\n") is not part of the line. The line is a view into the buffer of the reader. It is valid until the next call of @ref lr_next or @ref lr_close.
+@param[in,out] r line reader
+@param[out] line the line read
+@return @c true if a line has been read, @c false at end of input
+*/
+bool lr_next(LineReader *r, StringView *line);
+
+/**
+Closes the line reader and frees its memory. Closes the file if it has been opened with @ref lr_open.
+@param[in] r line reader
+*/
+void lr_close(LineReader *r);
+
+////////////////////////////////////////////////////////////////////////////
+// File writer
+
+/** Default buffer size of a file writer in bytes. */
+#define FW_DEFAULT_BUFFER_SIZE (1024 * 1024)
+
+/** Flag for @ref fw_open: Write to a temporary file in the same directory and rename it to the target name when closing. An existing target keeps its permissions. */
+#define FW_ATOMIC 1
+
+/** Flag for @ref fw_open: Force the data to disk (@c fsync) when closing. With @ref FW_ATOMIC, the rename is forced to disk as well. */
+#define FW_SYNC 2
+
+/** Flag for @ref fw_open: Append to the file rather than overwriting it. Cannot be combined with @ref FW_ATOMIC. */
+#define FW_APPEND 4
+
+/** Flag for @ref fw_open: Compress the data (see @ref compress.h). Each full buffer becomes a compressed block. Cannot be combined with @ref FW_APPEND. */
+#define FW_COMPRESS 8
+
+/**
+Writes to a file or file descriptor through a large buffer.
+@see fw_open, fw_of_fd, fw_write, fw_close
+*/
+typedef struct FileWriter {
+    int fd; ///< file descriptor to write to
+    int flags; ///< combination of FW_ATOMIC, FW_SYNC, FW_APPEND, FW_COMPRESS
+    bool close_at_end; ///< whether the writer opened the file itself
+    String name; ///< name of the target file, or NULL if writing to a given file descriptor
+    String temp_name; ///< name of the temporary file if FW_ATOMIC, NULL otherwise
+    char *buffer; ///< the output buffer
+    int capacity; ///< number of bytes allocated for buffer
+    int length; ///< number of bytes in buffer
+    size_t bytes_written; ///< total number of bytes written to the writer
+    Byte *packed; ///< buffer for a compressed block if FW_COMPRESS, otherwise NULL
+} FileWriter;
+
+/**
+Opens the file with the given name for writing. An existing file of the same name will be overwritten, unless @ref FW_APPEND is given. Exits the program if the file cannot be opened.
+@param[in] name file name (including path)
+@param[in] flags 0 or a combination of @ref FW_ATOMIC, @ref FW_SYNC, @ref FW_APPEND, and @ref FW_COMPRESS
+@param[in] buffer_size size of the output buffer in bytes, or 0 for @ref FW_DEFAULT_BUFFER_SIZE
+@return the file writer, close it with @ref fw_close
+@pre "not both atomic and append", !((flags & FW_ATOMIC) && (flags & FW_APPEND))
+@pre "not both compress and append", !((flags & FW_COMPRESS) && (flags & FW_APPEND))
+*/
+FileWriter *fw_open(String name, int flags, int buffer_size);
+
+/**
+Creates a file writer for an open file descriptor, e.g., 1 for standard output. The file descriptor is not closed by @ref fw_close.
+@param[in] fd file descriptor to write to
+@param[in] buffer_size size of the output buffer in bytes, or 0 for @ref FW_DEFAULT_BUFFER_SIZE
+@return the file writer, close it with @ref fw_close
+*/
+FileWriter *fw_of_fd(int fd, int buffer_size);
+
+/**
+Writes @c n bytes. Small writes are collected in the buffer. Writes larger than the buffer are passed on directly, together with the buffered data in a single vectored write.
+@param[in,out] w file writer
+@param[in] data the bytes to write
+@param[in] n number of bytes to write
+*/
+void fw_write(FileWriter *w, const void *data, size_t n);
+
+/**
+Writes several character sequences with a single vectored write (@c writev), if they do not fit into the buffer.
+@param[in,out] w file writer
+@param[in] parts the character sequences to write
+@param[in] n number of character sequences
+@pre "non-negative length", n >= 0
+*/
+void fw_writev(FileWriter *w, StringView *parts, int n);
+
+/** Writes a String. */
+void fw_prints(FileWriter *w, String s);
+
+/** Writes a character. */
+void fw_printc(FileWriter *w, char c);
+
+/** Writes an integer in decimal notation. */
+void fw_printi(FileWriter *w, int i);
+
+/** Writes a double, formatted like @ref printd. */
+void fw_printd(FileWriter *w, double d);
+
+/** Writes formatted output, like @c printf. */
+void fw_printf(FileWriter *w, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+Writes the buffered data to the file.
+@param[in,out] w file writer
+*/
+void fw_flush(FileWriter *w);
+
+/**
+Flushes and closes the file writer and frees its memory. Depending on the flags, forces the data to disk and renames the temporary file to the target name. Exits the program if any of these steps fails, e.g., because the disk is full.
+@param[in] w file writer
+*/
+void fw_close(FileWriter *w);
+
+////////////////////////////////////////////////////////////////////////////
+// Prefetching reader
+
+/** Default block size of a prefetching reader in bytes. */
+#define PR_DEFAULT_BLOCK_SIZE (4 * 1024 * 1024)
+
+/** Default number of blocks of a prefetching reader. */
+#define PR_DEFAULT_BLOCK_COUNT 3
+
+/**
+Reads a file in blocks with a background thread. The thread fills up to @c block_count blocks ahead of the caller and waits if all blocks are full (back-pressure). The block that the caller is processing is not overwritten until the caller asks for the next one.
+@see pr_open, pr_of_fd, pr_next, pr_close
+*/
+typedef struct PrefetchReader PrefetchReader;
+
+/**
+Opens the file with the given name for reading ahead and starts the background thread. Exits the program if the file cannot be opened.
+@param[in] name file name (including path)
+@param[in] block_size size of each block in bytes, or 0 for @ref PR_DEFAULT_BLOCK_SIZE
+@param[in] block_count number of blocks, at least 2, or 0 for @ref PR_DEFAULT_BLOCK_COUNT
+@return the reader, close it with @ref pr_close
+*/
+PrefetchReader *pr_open(String name, int block_size, int block_count);
+
+/**
+Creates a prefetching reader for an open file descriptor and starts the background thread. The file descriptor is not closed by @ref pr_close.
+@param[in] fd file descriptor to read from
+@param[in] block_size size of each block in bytes, or 0 for @ref PR_DEFAULT_BLOCK_SIZE
+@param[in] block_count number of blocks, at least 2, or 0 for @ref PR_DEFAULT_BLOCK_COUNT
+@return the reader, close it with @ref pr_close
+*/
+PrefetchReader *pr_of_fd(int fd, int block_size, int block_count);
+
+/**
+Gets the next block. Waits if the background thread has not read it yet. Hands the previous block back to the background thread for reuse. For a regular file, all blocks except the last one are full. For a pipe or socket, a block holds what one read returned, so the caller sees data as soon as it arrives.
+@param[in,out] r reader
+@param[out] data the data of the block, valid until the next call of @ref pr_next or @ref pr_close
+@param[out] n number of bytes in the block
+@return @c true if a block has been read, @c false at end of input
+*/
+bool pr_next(PrefetchReader *r, const Byte **data, int *n);
+
+/**
+Stops the background thread, closes the reader, and frees its memory. May be called before the end of the input has been reached, also while the background thread waits for data from a pipe or socket. Closes the file if it has been opened with @ref pr_open.
+@param[in] r reader
+*/
+void pr_close(PrefetchReader *r);
+
+////////////////////////////////////////////////////////////////////////////
+// Copying
+
+/**
+The result of a copy operation.
+@see copy_file, copy_fd
+*/
+typedef struct CopyResult {
+    size_t bytes; ///< number of bytes transferred
+    double seconds; ///< duration of the transfer in seconds
+    double mb_per_second; ///< throughput in megabytes (10^6 bytes) per second
+    String method; ///< the system call that transferred (most of) the data: "copy_file_range", "sendfile", "splice", or "read/write"
+} CopyResult;
+
+/**
+Transfers all data from one file descriptor to another, starting at their current positions, until the end of the input. Uses the fastest method that the kind of the file descriptors allows. Exits the program on read or write errors.
+@param[in] from file descriptor to read from, e.g., a file or a pipe
+@param[in] to file descriptor to write to
+@return number of bytes transferred, duration, and method
+@see copy_file
+*/
+CopyResult copy_fd(int from, int to);
+
+/**
+Copies a file. An existing file of the same name as the destination will be overwritten. Exits the program if a file cannot be opened or the data cannot be copied.
+@param[in] from name of the file to copy
+@param[in] to name of the copy
+@return number of bytes transferred, duration, and method
+@see copy_fd
+*/
+CopyResult copy_file(String from, String to);
+
+#endif
@@ -0,0 +1,245 @@
+/*
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#include <pthread.h>
+#include <unistd.h>
+#include "trace.h"
+
+#undef free // use the 'real' free here, the buffers are not tracked
+
+typedef struct Span {
+    String name;
+    int64_t start; // cycle counter
+    int64_t end; // cycle counter
+} Span;
+
+// The spans of a thread. Only the thread itself writes to its buffer.
+typedef struct TraceBuffer {
+    int thread_id;
+    int64_t n_spans; // number of spans recorded, the last TRACE_BUFFER_SIZE are kept
+    int depth; // number of open spans
+    String open_names[TRACE_MAX_DEPTH];
+    int64_t open_starts[TRACE_MAX_DEPTH];
+    Span spans[TRACE_BUFFER_SIZE];
+    struct TraceBuffer *next;
+} TraceBuffer;
+
+// The spans of a thread that has ended, in the order they were recorded.
+typedef struct RetiredSpans {
+    int thread_id;
+    int n_spans;
+    struct RetiredSpans *next;
+    Span spans[];
+} RetiredSpans;
+
+static bool tracing = false;
+static String trace_file = NULL;
+static bool write_at_exit_registered = false;
+
+// the buffers of running threads, and the spans of threads that have ended
+static TraceBuffer *buffers = NULL;
+static RetiredSpans *retired = NULL;
+static int n_threads = 0;
+static pthread_mutex_t buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread TraceBuffer *buffer = NULL;
+static pthread_key_t buffer_key;
+static pthread_once_t buffer_key_once = PTHREAD_ONCE_INIT;
+
+// Moves the kept spans of an ending thread to the retired spans, then frees
+// its buffer. Called by the thread itself.
+static void retire_buffer(Any arg) {
+    TraceBuffer *b = arg;
+    int64_t first = (b->n_spans > TRACE_BUFFER_SIZE) ? b->n_spans - TRACE_BUFFER_SIZE : 0;
+    int n = b->n_spans - first;
+    RetiredSpans *r = NULL;
+    if (n > 0) {
+        r = xmalloc(sizeof(RetiredSpans) + n * sizeof(Span));
+        base_untrack(r);
+        r->thread_id = b->thread_id;
+        r->n_spans = n;
+        for (int i = 0; i < n; i++) r->spans[i] = b->spans[(first + i) % TRACE_BUFFER_SIZE];
+    }
+    pthread_mutex_lock(&buffers_mutex);
+    TraceBuffer **p = &buffers;
+    while (*p != b) p = &(*p)->next;
+    *p = b->next;
+    if (r != NULL) {
+        r->next = retired;
+        retired = r;
+    }
+    pthread_mutex_unlock(&buffers_mutex);
+    // spans of this thread in later destructors go to a new buffer
+    buffer = NULL;
+    free(b);
+}
+
+static void create_buffer_key(void) {
+    if (pthread_key_create(&buffer_key, retire_buffer) != 0) {
+        fprintf(stderr, "trace_begin: Cannot create thread key.\n");
+        base_exit(EXIT_FAILURE);
+    }
+}
+
+static TraceBuffer *new_buffer(void) {
+    pthread_once(&buffer_key_once, create_buffer_key);
+    TraceBuffer *b = xcalloc(1, sizeof(TraceBuffer));
+    // the buffer lives until the thread ends, or the program exits for the
+    // main thread, it is not a leak
+    base_untrack(b);
+    pthread_mutex_lock(&buffers_mutex);
+    b->thread_id = ++n_threads;
+    b->next = buffers;
+    buffers = b;
+    pthread_mutex_unlock(&buffers_mutex);
+    pthread_setspecific(buffer_key, b);
+    return b;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Recording
+
+int trace_begin(String name) {
+    TraceBuffer *b = buffer;
+    bool on = __atomic_load_n(&tracing, __ATOMIC_RELAXED);
+    if (b == NULL) {
+        if (!on) return -1;
+        b = buffer = new_buffer();
+    }
+    // spans are also opened while tracing is off, such that
+    // trace_end matches the right span if tracing is switched in between
+    int depth = b->depth++;
+    if (depth < TRACE_MAX_DEPTH) {
+        b->open_names[depth] = name;
+        b->open_starts[depth] = on ? cycles_now() : -1;
+    }
+    return depth;
+}
+
+void trace_end(void) {
+    TraceBuffer *b = buffer;
+    if (b == NULL || b->depth == 0) return;
+    int depth = --b->depth;
+    if (depth >= TRACE_MAX_DEPTH || b->open_starts[depth] < 0) return;
+    int64_t end = cycles_now();
+    Span *s = &b->spans[b->n_spans % TRACE_BUFFER_SIZE];
+    s->name = b->open_names[depth];
+    s->start = b->open_starts[depth];
+    s->end = end;
+    b->n_spans++;
+}
+
+void trace_end_scope(int *depth) {
+    if (*depth >= 0) trace_end();
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Control
+
+static void write_at_exit(void) {
+    if (trace_file != NULL) trace_write(trace_file);
+}
+
+void trace_enable(String file) {
+    // calibrate now, not while writing the trace
+    cycles_per_ns();
+    pthread_mutex_lock(&buffers_mutex);
+    trace_file = file;
+    if (file != NULL && !write_at_exit_registered) {
+        atexit(write_at_exit);
+        write_at_exit_registered = true;
+    }
+    pthread_mutex_unlock(&buffers_mutex);
+    __atomic_store_n(&tracing, true, __ATOMIC_RELAXED);
+}
+
+void trace_disable(void) {
+    __atomic_store_n(&tracing, false, __ATOMIC_RELAXED);
+}
+
+void trace_clear(void) {
+    pthread_mutex_lock(&buffers_mutex);
+    for (TraceBuffer *b = buffers; b != NULL; b = b->next) b->n_spans = 0;
+    while (retired != NULL) {
+        RetiredSpans *r = retired;
+        retired = r->next;
+        free(r);
+    }
+    pthread_mutex_unlock(&buffers_mutex);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Output
+
+static void print_json_string(FILE *f, String s) {
+    fputc('"', f);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((Byte)*s < ' ') fprintf(f, "\\u%04x", *s);
+        else fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void print_thread_name(FILE *f, String *separator, int pid, int thread_id) {
+    fprintf(f, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, "
+            "\"args\": {\"name\": \"thread %d\"}}", *separator, pid, thread_id, thread_id);
+    *separator = ",\n";
+}
+
+static void print_span(FILE *f, String *separator, int pid, int thread_id, Span *s, int64_t origin) {
+    fprintf(f, "%s{\"name\": ", *separator);
+    print_json_string(f, s->name);
+    fprintf(f, ", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+            pid, thread_id, ns_of_cycles(s->start - origin) / 1000, ns_of_cycles(s->end - s->start) / 1000);
+    *separator = ",\n";
+}
+
+void trace_write(String file) {
+    require_not_null(file);
+    FILE *f = fopen(file, "w");
+    if (f == NULL) {
+        fprintf(stderr, "trace_write: Cannot open %s\n", file);
+        base_exit(EXIT_FAILURE);
+    }
+    pthread_mutex_lock(&buffers_mutex);
+    // timestamps relative to the earliest span, in microseconds
+    int64_t origin = INT64_MAX;
+    for (TraceBuffer *b = buffers; b != NULL; b = b->next) {
+        int64_t first = (b->n_spans > TRACE_BUFFER_SIZE) ? b->n_spans - TRACE_BUFFER_SIZE : 0;
+        for (int64_t i = first; i < b->n_spans; i++) {
+            int64_t start = b->spans[i % TRACE_BUFFER_SIZE].start;
+            if (start < origin) origin = start;
+        }
+    }
+    for (RetiredSpans *r = retired; r != NULL; r = r->next) {
+        for (int i = 0; i < r->n_spans; i++) {
+            if (r->spans[i].start < origin) origin = r->spans[i].start;
+        }
+    }
+    int pid = getpid();
+    fprintf(f, "{\"traceEvents\": [");
+    String separator = "\n";
+    for (TraceBuffer *b = buffers; b != NULL; b = b->next) {
+        print_thread_name(f, &separator, pid, b->thread_id);
+        int64_t first = (b->n_spans > TRACE_BUFFER_SIZE) ? b->n_spans - TRACE_BUFFER_SIZE : 0;
+        for (int64_t i = first; i < b->n_spans; i++) {
+            print_span(f, &separator, pid, b->thread_id, &b->spans[i % TRACE_BUFFER_SIZE], origin);
+        }
+    }
+    for (RetiredSpans *r = retired; r != NULL; r = r->next) {
+        print_thread_name(f, &separator, pid, r->thread_id);
+        for (int i = 0; i < r->n_spans; i++) {
+            print_span(f, &separator, pid, r->thread_id, &r->spans[i], origin);
+        }
+    }
+    pthread_mutex_unlock(&buffers_mutex);
+    fprintf(f, "\n], \"displayTimeUnit\": \"ns\"}\n");
+    if (fclose(f) != 0) {
+        fprintf(stderr, "trace_write: Cannot write %s\n", file);
+        base_exit(EXIT_FAILURE);
+    }
+}
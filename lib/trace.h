@@ -0,0 +1,111 @@
+/** @file
+Tracing of spans of time. A span is a named region of code, such as a function call or a phase of a computation. The start time and duration of each span are recorded in a buffer of the thread, which costs a few tens of nanoseconds per span. The spans of all threads can then be written as a trace in the Chrome trace event format, which shows where the time went on a timeline. Open the file in @c chrome://tracing or at https://ui.perfetto.dev.
+
+Example: Trace the phases of a program.
+@code{.c}
+void load(void) {
+    TRACE_SCOPE("load"); // ends when the function returns
+    ...
+}
+
+int main(void) {
+    trace_enable("trace.json"); // written when the program exits
+    load();
+    TRACE_BEGIN("compute");
+    ...
+    TRACE_END();
+    return 0;
+}
+@endcode
+
+Spans may be nested. Each thread keeps its most recent spans in a ring buffer, older spans are overwritten. When a thread ends, its buffer is freed and only its recorded spans are kept, until they are written or cleared. Recording is off until @ref trace_enable is called, then a span costs little more than reading the cycle counter twice. Defining @c NO_TRACE before including this header removes the macros from the code.
+
+@author Michael Rohs
+@date 18.10.2026
+@copyright Apache License, Version 2.0
+*/
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "base.h"
+
+/**
+Number of spans that each thread keeps.
+*/
+#define TRACE_BUFFER_SIZE 65536
+
+/**
+Maximum nesting depth of spans. Deeper spans are not recorded.
+*/
+#define TRACE_MAX_DEPTH 64
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef NO_TRACE
+    #define TRACE_BEGIN(name)
+    #define TRACE_END()
+    #define TRACE_SCOPE(name)
+#else
+    /**
+    Starts a span. Must be followed by @ref TRACE_END on the same thread.
+    @param[in] name the name of the span, must stay valid until the trace is written, e.g., a String literal
+    */
+    #define TRACE_BEGIN(name) trace_begin(name)
+
+    /**
+    Ends the most recently started span of the thread.
+    */
+    #define TRACE_END() trace_end()
+
+    /**
+    Starts a span that ends when the enclosing block is left, including by @c return or @c break.
+    @param[in] name the name of the span, must stay valid until the trace is written, e.g., a String literal
+    */
+    #define TRACE_SCOPE(name) \
+        __attribute__((cleanup(trace_end_scope))) int TRACE_CONCAT(trace_scope_, __LINE__) = trace_begin(name)
+#endif
+
+/**
+Starts recording spans.
+@param[in] file the file to write the trace to when the program exits, or NULL to write it only with @ref trace_write
+*/
+void trace_enable(String file);
+
+/**
+Stops recording spans. The recorded spans are kept.
+*/
+void trace_disable(void);
+
+/**
+Starts a span. Usually called by @ref TRACE_BEGIN or @ref TRACE_SCOPE.
+@param[in] name the name of the span
+@return the nesting depth of the span
+*/
+int trace_begin(String name);
+
+/**
+Ends the most recently started span of the thread. Usually called by @ref TRACE_END.
+*/
+void trace_end(void);
+
+/**
+Ends a span at the end of a block. Called by @ref TRACE_SCOPE.
+@param[in] depth the nesting depth of the span
+@private
+*/
+void trace_end_scope(int *depth);
+
+/**
+Writes the recorded spans of all threads as Chrome trace event JSON. Should be called while no other thread records spans. Exits the program if the file cannot be written.
+@param[in] file the file to write to
+*/
+void trace_write(String file);
+
+/**
+Discards the recorded spans of all threads. Should be called while no other thread records spans.
+*/
+void trace_clear(void);
+
+#endif